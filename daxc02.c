@@ -25,13 +25,22 @@
  */
 
 #include <linux/device.h>
+#include <linux/crc32.h>
 #include <linux/delay.h>
+#include <linux/firmware.h>
 #include <linux/i2c.h>
+#include <linux/interrupt.h>
+#include <linux/ktime.h>
 #include <linux/module.h>
+#include <linux/mutex.h>
+#include <linux/sysfs.h>
+#include <linux/thermal.h>
 #include <linux/videodev2.h>
+#include <linux/workqueue.h>
 
 #include <media/v4l2-ctrls.h>
 #include <media/v4l2-device.h>
+#include <media/v4l2-event.h>
 #include <media/v4l2-subdev.h>
 
 #include <linux/of.h>
@@ -51,6 +60,22 @@
         TC358746AXBG MIPI Converter Defines
 ****************************************************/
 
+#define TC358746_FIFO_STATUS            0x00F8
+#define TC358746_PPI_STARTCNTRL         0x0204
+#define TC358746_CSI_ERR                0x044C
+#define TC358746_CSI_START              0x0518
+
+/*
+ * Video buffer overflow and underflow, write 1 to clear.
+ */
+#define TC358746_FIFO_ERRORS            0x0003
+
+/*
+ * Each bridge drives 2 CSI lanes of RAW12.
+ */
+#define DAXC02_CSI_LANES                2
+#define DAXC02_BITS_PER_PIXEL           12
+
 struct daxc02_mipi_settings {
     uint8_t len;
     uint16_t addr;
@@ -84,14 +109,194 @@ const struct daxc02_mipi_settings daxc02_buffer_config[] = {
     {4, 0x022C, 0x00000004}, // data trail counter
     {4, 0x0234, 0x00000007}, // voltage regulator enable
     {4, 0x0238, 0x00000000}, // discontinuous clock mode.
-    {4, 0x0204, 0x00000001}, // TX PPI start
+    {4, TC358746_PPI_STARTCNTRL, 0x00000001}, // TX PPI start
 
-    {4, 0x0518, 0x00000001}, // CSI start
+    {4, TC358746_CSI_START, 0x00000001}, // CSI start
     {4, 0x0500, 0xA30080A3}, // 2 data lanes
 
     {2, 0x0004, 0x0045}, // increment I2C, parallel port enable, 2 csi lanes
 };
 
+/*
+ * Replaces entries of daxc02_buffer_config for modes clocked at
+ * MT9M021_TARGET_FREQ_LOW.  The PLL keeps its 900MHz VCO and the output
+ * divider halves the lane rate to 450Mbps, which still carries the halved
+ * pixel rate.  The D-PHY counters are rescaled to the 56.25MHz byte clock
+ * so each interval keeps at least its full rate duration.  The FIFO level
+ * is unchanged, as input and output slow down together.
+ */
+const struct daxc02_mipi_settings daxc02_buffer_low_clock[] = {
+    {2, 0x0018, 0x0613}, // PLL output divided by 2
+    {4, 0x0210, 0x00001600}, // line intialization wait counter, 100us
+    {4, 0x0214, 0x00000003}, // timing generation counter
+    {4, 0x0218, 0x00001002}, // clock header counter
+    {4, 0x021C, 0x00000002}, // clock trail counter
+    {4, 0x0220, 0x00000503}, // data header counter
+    {4, 0x0224, 0x000036EF}, // wakeup counter, 1ms
+    {4, 0x022C, 0x00000003}, // data trail counter
+};
+
+/*
+ * Re-kicks the bridge transmitter without touching the PLL or FIFO setup.
+ */
+const struct daxc02_mipi_settings daxc02_buffer_restart[] = {
+    {4, TC358746_PPI_STARTCNTRL, 0x00000001}, // TX PPI start
+    {4, TC358746_CSI_START, 0x00000001}, // CSI start
+};
+
+/***************************************************
+        Stalled Stream Watchdog
+****************************************************/
+
+static bool watchdog = true;
+module_param(watchdog, bool, 0644);
+MODULE_PARM_DESC(watchdog, "Restart the bridge/sensor when the frame counter stalls");
+
+/*
+ * Escalation levels, each more expensive than the last.
+ */
+enum {
+    DAXC02_RECOVER_NONE,
+    DAXC02_RECOVER_BRIDGE,
+    DAXC02_RECOVER_STREAM,
+    DAXC02_RECOVER_REINIT,
+};
+
+#define DAXC02_WATCHDOG_FRAMES          2
+#define DAXC02_WATCHDOG_MIN_US          10000
+
+/* each reinit doubles the wait before the next check, then the watchdog gives up */
+#define DAXC02_WATCHDOG_MAX_REINITS     5
+
+struct daxc02_stats {
+    uint32_t stalls;
+    uint32_t bridge_faults;
+    uint32_t bridge_restarts;
+    uint32_t stream_restarts;
+    uint32_t reinits;
+    uint32_t recovered;
+    uint32_t late_ctrls;
+    uint32_t snapshots;
+    uint32_t thermal_throttles;
+    uint32_t strobe_misses;
+};
+
+/***************************************************
+        Thermal Governor
+****************************************************/
+
+static unsigned int thermal_interval_ms = 1000;
+module_param(thermal_interval_ms, uint, 0644);
+MODULE_PARM_DESC(thermal_interval_ms, "Sensor temperature sample period in ms, 0 disables sampling");
+
+/*
+ * Defaults for the optional thermal-resume-millicelsius and thermal-min-fps
+ * device tree properties.
+ */
+#define DAXC02_THERMAL_HYSTERESIS       10000
+#define DAXC02_THERMAL_MIN_FPS          5
+
+/***************************************************
+        Frame-Tagged Control Queue
+****************************************************/
+
+/*
+ * Registers written inside a grouped parameter hold latch at the start of
+ * the next frame.  Gain and frame length apply to that frame, N+1.  The
+ * rolling shutter has already started integrating N+1 by then, so a new
+ * integration time first shows on N+2.  DAXC02_CTRL_LATENCY is the longest
+ * of these, the earliest target every control can meet.  Each one is also
+ * reported by its own read only control.
+ */
+#define DAXC02_GAIN_LATENCY             1
+#define DAXC02_EXPOSURE_LATENCY         2
+#define DAXC02_FRAME_RATE_LATENCY       1
+#define DAXC02_CTRL_LATENCY             2
+#define DAXC02_QUEUE_SIZE               16
+#define DAXC02_QUEUE_MIN_US             1000
+
+struct daxc02_queued_ctrl {
+    uint32_t frame;
+    uint32_t id;
+    int64_t value;
+};
+
+struct daxc02_ctrl_latency {
+    uint32_t id;
+    int32_t frames;
+};
+
+/*
+ * Frames from the write to the first frame a queued control affects.
+ */
+static const struct daxc02_ctrl_latency daxc02_ctrl_latencies[] = {
+    {TEGRA_CAMERA_CID_GAIN,             DAXC02_GAIN_LATENCY},
+    {TEGRA_CAMERA_CID_EXPOSURE,         DAXC02_EXPOSURE_LATENCY},
+    {TEGRA_CAMERA_CID_FRAME_RATE,       DAXC02_FRAME_RATE_LATENCY},
+};
+
+/***************************************************
+        V4L2 Events
+****************************************************/
+
+/*
+ * Enough for one event per queued control between reads.
+ */
+#define DAXC02_EVENT_QUEUE_LEN          DAXC02_QUEUE_SIZE
+
+/***************************************************
+        Firmware Tables
+****************************************************/
+
+/*
+ * Register tables loaded from firmware are pre-encoded into i2c messages
+ * and replayed with one i2c_transfer per batch.  A batch ends at each wait.
+ */
+struct daxc02_fw_batch {
+    struct i2c_msg *msgs;
+    unsigned int num_msgs;
+    unsigned int wait_ms;
+};
+
+struct daxc02_fw_table {
+    struct daxc02_fw_batch *batches;
+    unsigned int num_batches;
+};
+
+struct daxc02_fw {
+    uint32_t revision;
+    unsigned int num_modes;
+    struct daxc02_fw_table common;
+    struct daxc02_fw_table bridge;
+    struct daxc02_fw_table bridge_low_clock;
+    struct daxc02_fw_table *modes;
+    struct camera_common_frmfmt *frmfmt;
+    int *framerates;
+    const char **isp_profile;
+};
+
+/***************************************************
+        Sensor Timing Model
+****************************************************/
+
+/*
+ * Precomputed for the current mode and line length when the format changes
+ * or a stream starts, so control paths only multiply and shift.  A frame
+ * lasts frame_length_lines * line_length_pck pixel clocks.
+ */
+#define DAXC02_LINE_RATE_SHIFT          16
+#define DAXC02_PS_PER_SEC               1000000000000ULL
+
+struct daxc02_timing {
+    uint32_t pix_clk;
+    uint32_t line_length;
+    uint64_t line_rate;
+    uint32_t line_time_ps;
+    uint32_t min_frame_length;
+    uint32_t max_frame_length;
+    int64_t max_exposure;
+};
+
 /***************************************************
         DAX-C02 Private Structure
 ****************************************************/
@@ -100,14 +305,64 @@ struct daxc02 {
     struct camera_common_power_rail     power;
     int                                 numctrls;
     struct v4l2_ctrl_handler            ctrl_handler;
+    struct v4l2_ctrl_config             *ctrl_config;
     struct i2c_client                   *i2c_client;
     struct v4l2_subdev                  *subdev;
     struct media_pad                    pad;
     struct camera_common_data           *s_data;
     struct camera_common_pdata          *pdata;
+    struct daxc02_fw                    *fw;
+    const char * const                  *isp_profile;
 
     uint16_t                            coarse_time;
     uint16_t                            frame_length;
+    uint16_t                            frame_length_req;
+    struct daxc02_timing                timing;
+
+    struct mutex                        lock;
+    struct delayed_work                 monitor;
+    bool                                streaming;
+    uint32_t                            watchdog_seq;
+    int                                 stall_level;
+    uint32_t                            stall_source;
+    unsigned int                        reinit_count;
+    struct daxc02_stats                 stats;
+
+    spinlock_t                          queue_lock;
+    struct delayed_work                 apply;
+    struct daxc02_queued_ctrl           queue[DAXC02_QUEUE_SIZE];
+    unsigned int                        queue_len;
+    uint32_t                            target_frame;
+    uint16_t                            frame_count;
+    uint32_t                            frame_seq;
+    int                                 hold_count;
+
+    uint16_t                            gain;
+    bool                                snapshot;
+    bool                                low_latency;
+    uint32_t                            *mode_line_length;
+
+    struct delayed_work                 thermal;
+    struct thermal_zone_device          *tz;
+    uint16_t                            temp_calib[2];
+    int                                 temperature;
+    bool                                temp_valid;
+    int                                 throttle_temp;
+    int                                 resume_temp;
+    unsigned int                        min_fps;
+    unsigned int                        thermal_level;
+    int64_t                             frame_rate;
+    int64_t                             frame_rate_cap;
+    int                                 strobe_gpio;
+    int                                 strobe_irq;
+    bool                                strobe_armed;
+    uint32_t                            strobe_frame;
+    uint64_t                            strobe_rise;
+    int64_t                             exposure_timestamp;
+    struct device_node                  *stereo_node;
+    struct daxc02                       *stereo_primary;
+    struct daxc02                       *stereo_secondary;
+    bool                                stereo_sync;
 
     struct v4l2_ctrl                    *ctrls[];
 };
@@ -117,32 +372,110 @@ struct daxc02 {
 ****************************************************/
 
 static int daxc02_s_ctrl(struct v4l2_ctrl *ctrl);
+static int daxc02_g_volatile_ctrl(struct v4l2_ctrl *ctrl);
 static int daxc02_power_on(struct camera_common_data *s_data);
 static int daxc02_power_off(struct camera_common_data *s_data);
 static int daxc02_power_get(struct daxc02 *priv);
+static void daxc02_queue_event(struct i2c_client *client, uint32_t type, const struct daxc02_event_data *data);
+static void daxc02_error_event(struct i2c_client *client, uint32_t source, uint16_t addr, int error);
 static int mt9m021_read(struct i2c_client *client, uint16_t addr, uint16_t *val);
 static int mt9m021_write(struct i2c_client *client, uint16_t addr, uint16_t val);
 static int mt9m021_write_table(struct i2c_client *client, const struct reg_16 table[]);
-static int daxc02_bridge_setup(struct i2c_client *client);
+static int mt9m021_group_hold(struct daxc02 *priv, bool hold);
+static int daxc02_bridge_write(struct i2c_client *client, const struct daxc02_mipi_settings *settings);
+static int daxc02_bridge_read(struct i2c_client *client, uint8_t len, uint16_t addr, uint32_t *data);
+static int daxc02_bridge_faults(struct i2c_client *client, bool *faulted);
+static uint32_t daxc02_bridge_data(uint16_t addr, uint32_t data, bool low_clock);
+static int daxc02_bridge_setup(struct i2c_client *client, bool low_clock);
+static int daxc02_bridge_restart(struct i2c_client *client);
 static int mt9m021_set_gain(struct daxc02 *priv, int64_t value);
+static uint32_t mt9m021_line_length(struct daxc02 *priv);
+static uint32_t mt9m021_frame_length(struct daxc02 *priv, int64_t frame_rate);
+static int64_t mt9m021_exposure(struct daxc02 *priv, uint32_t lines);
+static void daxc02_timing_update(struct daxc02 *priv, int64_t min_frame_rate, int64_t max_frame_rate);
+static int mt9m021_set_vfr(struct daxc02 *priv, uint32_t coarse_time);
 static int mt9m021_set_exposure(struct daxc02 *priv, int64_t value);
 static int mt9m021_set_frame_rate(struct daxc02 *priv, int64_t value);
 static int mt9m021_set_flash(struct i2c_client *client, enum v4l2_flash_led_mode flash_mode);
+static int mt9m021_snapshot(struct daxc02 *priv);
+static int daxc02_start_stream(struct daxc02 *priv);
+static unsigned int daxc02_frame_period_us(struct daxc02 *priv);
+static unsigned int daxc02_readout_time_us(struct daxc02 *priv);
+static int daxc02_recover(struct daxc02 *priv, int level);
+static void daxc02_monitor_schedule(struct daxc02 *priv);
+static void daxc02_monitor(struct work_struct *work);
+static void daxc02_frame_seq_update(struct daxc02 *priv, uint16_t frame_count);
+static void daxc02_frame_seq_sync(struct daxc02 *priv);
+static void daxc02_frame_seq_rebase(struct daxc02 *priv);
+static int32_t daxc02_ctrl_latency(uint32_t id);
+static int daxc02_apply_ctrl(struct daxc02 *priv, uint32_t id, int64_t value);
+static int daxc02_apply_ctrls(struct daxc02 *priv, const struct daxc02_queued_ctrl *ctrls, unsigned int count);
+static int daxc02_submit_ctrl(struct daxc02 *priv, uint32_t id, int64_t value);
+static void daxc02_apply_schedule(struct daxc02 *priv);
+static void daxc02_apply_queue(struct work_struct *work);
+static void daxc02_stereo_bind(struct daxc02 *priv);
+static void daxc02_stereo_cache(struct daxc02 *priv, uint32_t id, int64_t value);
+static struct v4l2_ctrl *daxc02_ctrl_get(struct daxc02 *priv, uint32_t id);
+static struct v4l2_ctrl_config *daxc02_ctrl_config_get(struct daxc02 *priv, uint32_t id);
+static void daxc02_ctrl_config_dt(struct daxc02 *priv);
+static void daxc02_stereo_unbind(struct daxc02 *priv);
+static bool daxc02_stereo_lockstep(struct daxc02 *priv);
 static int mt9m021_s_stream(struct v4l2_subdev *sd, int enable);
+static int daxc02_subscribe_event(struct v4l2_subdev *sd, struct v4l2_fh *fh, struct v4l2_event_subscription *sub);
 static int daxc02_g_input_status(struct v4l2_subdev *sd, uint32_t *status);
 static int mt9m021_get_format(struct v4l2_subdev *sd, struct v4l2_subdev_pad_config *cfg, struct v4l2_subdev_format *format);
 static int mt9m021_set_format(struct v4l2_subdev *sd, struct v4l2_subdev_pad_config *cfg, struct v4l2_subdev_format *format);
+static void daxc02_update_mode(struct daxc02 *priv);
+static int daxc02_size_max_fps(struct camera_common_data *s_data);
+static bool daxc02_select_mode(struct daxc02 *priv, int64_t frame_rate);
+static void daxc02_mode_timing(struct daxc02 *priv, int64_t min_frame_rate);
 static int daxc02_open(struct v4l2_subdev *sd, struct v4l2_subdev_fh *fh);
 static struct camera_common_pdata *daxc02_parse_dt(struct i2c_client *client, struct camera_common_data *s_data);
+static void daxc02_set_default_mode(struct camera_common_data *s_data, uint32_t mode);
+static int daxc02_fw_alloc(struct device *dev, struct daxc02_fw_table *table, unsigned int num_batches, unsigned int num_msgs, size_t msg_len);
+static int daxc02_fw_encode_regs(struct daxc02 *priv, const struct daxc02_fw_reg *regs, uint32_t count, struct daxc02_fw_table *table);
+static int daxc02_fw_encode_bridge(struct daxc02 *priv, const struct daxc02_fw_bridge *regs, uint32_t count, bool low_clock, struct daxc02_fw_table *table);
+static int daxc02_fw_parse(struct daxc02 *priv, const struct firmware *blob);
+static int daxc02_fw_load(struct daxc02 *priv);
+static int daxc02_fw_replay(struct i2c_client *client, const struct daxc02_fw_table *table);
+static void daxc02_check_bandwidth(struct daxc02 *priv);
+static int daxc02_temp_start(struct daxc02 *priv);
+static int daxc02_temp_sample(struct daxc02 *priv);
+static void daxc02_thermal_govern(struct daxc02 *priv);
+static void daxc02_thermal_schedule(struct daxc02 *priv);
+static void daxc02_thermal(struct work_struct *work);
+static int daxc02_thermal_get_temp(void *data, int *temp);
+static void daxc02_thermal_init(struct daxc02 *priv);
+static irqreturn_t daxc02_strobe_irq(int irq, void *dev_id);
+static void daxc02_strobe_arm(struct daxc02 *priv, bool arm);
+static int daxc02_strobe_init(struct daxc02 *priv);
 static int daxc02_ctrls_init(struct daxc02 *priv);
 static int daxc02_probe(struct i2c_client *client, const struct i2c_device_id *id);
 static int daxc02_remove(struct i2c_client *client);
 
+static struct i2c_driver daxc02_i2c_driver;
+
 
 /***************************************************
         V4L2 Control Configuration
 ****************************************************/
 
+/*
+ * Optional per-instance device tree ranges, each <min default max>.  scale
+ * is the property's units per 1.0 of the control.
+ */
+struct daxc02_ctrl_dt {
+    uint32_t id;
+    const char *prop;
+    uint32_t scale;
+};
+
+static const struct daxc02_ctrl_dt daxc02_ctrl_dt_props[] = {
+    {TEGRA_CAMERA_CID_GAIN,             "gain-range",           100000},
+    {TEGRA_CAMERA_CID_EXPOSURE,         "exposure-range-us",    1000000},
+    {TEGRA_CAMERA_CID_FRAME_RATE,       "frame-rate-range",     1},
+};
+
 /*
  * Extra test pattern information to display to the user.
  */
@@ -154,33 +487,81 @@ static const char * const mt9m021_test_pattern_menu[] = {
     "256: Walking 1s test pattern (12 bit)"
 };
 
+/*
+ * MT9M021_TEST_PATTERN value for each menu entry.
+ */
+static const uint16_t mt9m021_test_pattern_val[] = {
+    0x0000,
+    0x0001,
+    0x0002,
+    0x0003,
+    0x0100,
+};
+
 /** daxc02_s_ctrl - Called by the V4L2 framework to set a control.
   * @ctrl:  struct containing the control id to switch off of and
   *         value to set from the v4l2 framework.
   */
 static int daxc02_s_ctrl(struct v4l2_ctrl *ctrl)
 {
+    struct v4l2_ctrl *isp;
+    unsigned long flags;
     uint16_t reg16;
     int ret = 0;
 
     struct daxc02 *priv = container_of(ctrl->handler, struct daxc02, ctrl_handler);
     struct i2c_client *client = v4l2_get_subdevdata(priv->subdev);
 
+    /* latched even while powered off so it applies to the next batch */
+    if(ctrl->id == DAXC02_CID_TARGET_FRAME)
+    {
+        dev_dbg(&client->dev, "%s: DAXC02_CID_TARGET_FRAME (0x%x) - %lld\n", __func__, ctrl->id, *ctrl->p_new.p_s64);
+        spin_lock_irqsave(&priv->queue_lock, flags);
+        priv->target_frame = (uint32_t)*ctrl->p_new.p_s64;
+        spin_unlock_irqrestore(&priv->queue_lock, flags);
+        return 0;
+    }
+
+    /* grabbed while streaming, takes effect on the next stream on */
+    if(ctrl->id == DAXC02_CID_SNAPSHOT_MODE)
+    {
+        dev_dbg(&client->dev, "%s: DAXC02_CID_SNAPSHOT_MODE (0x%x) - %d\n", __func__, ctrl->id, ctrl->val);
+        priv->snapshot = ctrl->val;
+        return 0;
+    }
+
+    /* grabbed while streaming, takes effect on the next stream on */
+    if(ctrl->id == DAXC02_CID_LOW_LATENCY)
+    {
+        dev_dbg(&client->dev, "%s: DAXC02_CID_LOW_LATENCY (0x%x) - %d\n", __func__, ctrl->id, ctrl->val);
+        priv->low_latency = ctrl->val;
+        return 0;
+    }
+
+    /* the mode is settled before stream on, so VI programs the clock the sensor runs */
+    if(ctrl->id == TEGRA_CAMERA_CID_FRAME_RATE && !priv->streaming && !priv->stereo_primary &&
+       daxc02_select_mode(priv, *ctrl->p_new.p_s64))
+    {
+        isp = daxc02_ctrl_get(priv, DAXC02_CID_ISP_PROFILE);
+        if(isp) __v4l2_ctrl_s_ctrl_string(isp, priv->isp_profile[priv->s_data->mode]);
+        daxc02_mode_timing(priv, ctrl->minimum);
+    }
+
     if(priv->power.state == SWITCH_OFF) return 0;
 
     switch (ctrl->id)
     {
         case TEGRA_CAMERA_CID_GAIN:
             dev_dbg(&client->dev, "%s: TEGRA_CAMERA_CID_GAIN (0x%x) - %lld\n", __func__, ctrl->id, *ctrl->p_new.p_s64);
-            ret = mt9m021_set_gain(priv, *ctrl->p_new.p_s64);
+            ret = daxc02_submit_ctrl(priv, ctrl->id, *ctrl->p_new.p_s64);
             break;
         case TEGRA_CAMERA_CID_EXPOSURE:
             dev_dbg(&client->dev, "%s: TEGRA_CAMERA_CID_EXPOSURE (0x%x) - %lld\n", __func__, ctrl->id, *ctrl->p_new.p_s64);
-            ret = mt9m021_set_exposure(priv, *ctrl->p_new.p_s64);
+            ret = daxc02_submit_ctrl(priv, ctrl->id, *ctrl->p_new.p_s64);
             break;
         case TEGRA_CAMERA_CID_FRAME_RATE:
             dev_dbg(&client->dev, "%s: TEGRA_CAMERA_CID_FRAME_RATE (0x%x) - %lld\n", __func__, ctrl->id, *ctrl->p_new.p_s64);
-            ret = mt9m021_set_frame_rate(priv, *ctrl->p_new.p_s64);
+            ret = daxc02_submit_ctrl(priv, ctrl->id, *ctrl->p_new.p_s64);
             break;
         case TEGRA_CAMERA_CID_HDR_EN:
             dev_dbg(&client->dev, "%s: TEGRA_CAMERA_CID_HDR_EN (0x%x) - %d\n", __func__, ctrl->id, ctrl->val);
@@ -188,16 +569,6 @@ static int daxc02_s_ctrl(struct v4l2_ctrl *ctrl)
         case TEGRA_CAMERA_CID_GROUP_HOLD:
             dev_dbg(&client->dev, "%s: TEGRA_CAMERA_CID_GROUP_HOLD (0x%x) - %d\n", __func__, ctrl->id, ctrl->val);
             break;
-        case V4L2_CID_ANALOGUE_GAIN:
-            dev_dbg(&client->dev, "%s: V4L2_CID_ANALOGUE_GAIN (0x%x) - %d\n", __func__, ctrl->id, ctrl->val);
-            ret = mt9m021_read(client, MT9M021_DIGITAL_TEST, &reg16);
-            if(!ret)
-            {
-                reg16 &= ~MT9M021_ANALOGUE_GAIN_MASK;
-                reg16 |= ((ctrl->val << MT9M021_ANALOGUE_GAIN_SHIFT) & MT9M021_ANALOGUE_GAIN_MASK);
-                ret = mt9m021_write(client, MT9M021_DIGITAL_TEST, reg16);
-            }
-            break;
         case V4L2_CID_HFLIP:
             dev_dbg(&client->dev, "%s: V4L2_CID_HFLIP (0x%x) - %d\n", __func__, ctrl->id, ctrl->val);
             ret = mt9m021_read(client, MT9M021_READ_MODE, &reg16);
@@ -232,34 +603,20 @@ static int daxc02_s_ctrl(struct v4l2_ctrl *ctrl)
             break;
         case V4L2_CID_TEST_PATTERN:
             dev_dbg(&client->dev, "%s: V4L2_CID_TEST_PATTERN (0x%x) - %d\n", __func__, ctrl->id, ctrl->val);
-            switch(ctrl->val)
-            {
-                case 0:
-                    dev_info(&client->dev, "Test Pattern Disabled\n");
-                    ret = mt9m021_write(client, MT9M021_TEST_PATTERN, 0x0);
-                    break;
-                case 1:
-                    dev_info(&client->dev, "Test Pattern Solid\n");
-                    ret = mt9m021_write(client, MT9M021_TEST_PATTERN, 0x1);
-                    break;
-                case 2:
-                    dev_info(&client->dev, "Test Pattern Color Bars\n");
-                    ret = mt9m021_write(client, MT9M021_TEST_PATTERN, 0x2);
-                    break;
-                case 3:
-                    dev_info(&client->dev, "Test Pattern Fade\n");
-                    ret = mt9m021_write(client, MT9M021_TEST_PATTERN, 0x3);
-                    break;
-                case 4:
-                    dev_info(&client->dev, "Test Pattern Walking\n");
-                    ret = mt9m021_write(client, MT9M021_TEST_PATTERN, 0x100);
-                    break;
-            }
+            dev_info(&client->dev, "Test Pattern %s\n", mt9m021_test_pattern_menu[ctrl->val]);
+            ret = mt9m021_write(client, MT9M021_TEST_PATTERN, mt9m021_test_pattern_val[ctrl->val]);
             break;
         case V4L2_CID_FLASH_LED_MODE:
             dev_dbg(&client->dev, "%s: V4L2_CID_FLASH_LED_MODE (0x%x) - %d\n", __func__, ctrl->id, ctrl->val);
             ret = mt9m021_set_flash(client, (enum v4l2_flash_led_mode)ctrl->val);
             break;
+        case DAXC02_CID_ISP_PROFILE:
+            dev_dbg(&client->dev, "%s: DAXC02_CID_ISP_PROFILE (0x%x) - %s\n", __func__, ctrl->id, ctrl->p_new.p_char);
+            break;
+        case DAXC02_CID_SNAPSHOT_TRIGGER:
+            dev_dbg(&client->dev, "%s: DAXC02_CID_SNAPSHOT_TRIGGER (0x%x)\n", __func__, ctrl->id);
+            ret = mt9m021_snapshot(priv);
+            break;
         default:
             dev_err(&client->dev, "%s: UNKNOWN CTRL ID (0x%x)\n", __func__, ctrl->id);
             return -EINVAL;
@@ -268,17 +625,69 @@ static int daxc02_s_ctrl(struct v4l2_ctrl *ctrl)
     return ret;
 }
 
+/** daxc02_g_volatile_ctrl - Called by the V4L2 framework to read a volatile control.
+  * @ctrl:  struct containing the control id to read.
+  */
+static int daxc02_g_volatile_ctrl(struct v4l2_ctrl *ctrl)
+{
+    struct daxc02 *priv = container_of(ctrl->handler, struct daxc02, ctrl_handler);
+    struct i2c_client *client = v4l2_get_subdevdata(priv->subdev);
+    unsigned long flags;
+
+    switch (ctrl->id)
+    {
+        case DAXC02_CID_FRAME_COUNT:
+            if(priv->streaming) daxc02_frame_seq_sync(priv);
+            *ctrl->p_new.p_s64 = priv->frame_seq;
+            break;
+        case DAXC02_CID_STEREO_LOCKSTEP:
+            ctrl->val = daxc02_stereo_lockstep(priv);
+            break;
+        case DAXC02_CID_READOUT_TIME:
+            ctrl->val = daxc02_readout_time_us(priv);
+            break;
+        case DAXC02_CID_TEMPERATURE:
+            ctrl->val = priv->temperature;
+            break;
+        case DAXC02_CID_EXPOSURE_ACTUAL:
+            *ctrl->p_new.p_s64 = mt9m021_exposure(priv, priv->coarse_time);
+            break;
+        case DAXC02_CID_FRAME_PERIOD:
+            ctrl->val = daxc02_frame_period_us(priv);
+            break;
+        case DAXC02_CID_LINE_TIME:
+            ctrl->val = priv->timing.line_time_ps / 1000;
+            break;
+        case DAXC02_CID_TARGET_FRAME:
+            spin_lock_irqsave(&priv->queue_lock, flags);
+            *ctrl->p_new.p_s64 = priv->target_frame;
+            spin_unlock_irqrestore(&priv->queue_lock, flags);
+            break;
+        case DAXC02_CID_EXPOSURE_TIMESTAMP:
+            spin_lock_irqsave(&priv->queue_lock, flags);
+            *ctrl->p_new.p_s64 = priv->exposure_timestamp;
+            spin_unlock_irqrestore(&priv->queue_lock, flags);
+            break;
+        default:
+            dev_err(&client->dev, "%s: UNKNOWN CTRL ID (0x%x)\n", __func__, ctrl->id);
+            return -EINVAL;
+    }
+
+    return 0;
+}
+
 /*
  * Registers the control operations with the v4l2 framework.
  */
 static const struct v4l2_ctrl_ops daxc02_ctrl_ops = {
     .s_ctrl             = daxc02_s_ctrl,
+    .g_volatile_ctrl    = daxc02_g_volatile_ctrl,
 };
 
 /*
  * List of controls and limits that can be set through the v4l2 framework.
  */
-static struct v4l2_ctrl_config ctrl_config_list[] = {
+static const struct v4l2_ctrl_config ctrl_config_list[] = {
     /* NVIDIA controls */
     {
         .ops            = &daxc02_ctrl_ops,
@@ -287,7 +696,7 @@ static struct v4l2_ctrl_config ctrl_config_list[] = {
         .type           = V4L2_CTRL_TYPE_INTEGER64,
         .flags          = V4L2_CTRL_FLAG_SLIDER,
         .min            = 100000 * FIXED_POINT_SCALING_FACTOR / 100000,
-        .max            = 796875 * FIXED_POINT_SCALING_FACTOR / 100000,
+        .max            = 6375000 * FIXED_POINT_SCALING_FACTOR / 100000,
         .def            = 100000 * FIXED_POINT_SCALING_FACTOR / 100000,
         .step           = 3125 * FIXED_POINT_SCALING_FACTOR / 100000,
     },
@@ -298,7 +707,7 @@ static struct v4l2_ctrl_config ctrl_config_list[] = {
         .type           = V4L2_CTRL_TYPE_INTEGER64,
         .flags          = V4L2_CTRL_FLAG_SLIDER,
         .min            = 23 * FIXED_POINT_SCALING_FACTOR / 1000000,
-        .max            = 30000 * FIXED_POINT_SCALING_FACTOR / 1000000,
+        .max            = 999933 * FIXED_POINT_SCALING_FACTOR / 1000000,
         .def            = 5689 * FIXED_POINT_SCALING_FACTOR / 1000000,
         .step           = 1,
     },
@@ -337,16 +746,6 @@ static struct v4l2_ctrl_config ctrl_config_list[] = {
     },
 
     /* Other MT9M021 controls */
-    {
-        .ops            = &daxc02_ctrl_ops,
-        .id             = V4L2_CID_ANALOGUE_GAIN,
-        .type           = V4L2_CTRL_TYPE_INTEGER,
-        .name           = "Gain, Column",
-        .min            = MT9M021_ANALOGUE_GAIN_MIN,
-        .max            = MT9M021_ANALOGUE_GAIN_MAX,
-        .def            = MT9M021_ANALOGUE_GAIN_DEF,
-        .step           = 1,
-    },
     {
         .ops            = &daxc02_ctrl_ops,
         .id             = V4L2_CID_FLASH_LED_MODE,
@@ -393,6 +792,191 @@ static struct v4l2_ctrl_config ctrl_config_list[] = {
         .menu_skip_mask = 0,
         .qmenu          = mt9m021_test_pattern_menu,
     },
+
+    /* DAX-C02 controls */
+    {
+        .ops            = &daxc02_ctrl_ops,
+        .id             = DAXC02_CID_ISP_PROFILE,
+        .name           = "ISP Profile",
+        .type           = V4L2_CTRL_TYPE_STRING,
+        .flags          = V4L2_CTRL_FLAG_READ_ONLY,
+        .min            = 0,
+        .max            = DAXC02_ISP_PROFILE_LEN,
+        .step           = 1,
+    },
+    {
+        .ops            = &daxc02_ctrl_ops,
+        .id             = DAXC02_CID_FRAME_COUNT,
+        .name           = "Frame Count",
+        .type           = V4L2_CTRL_TYPE_INTEGER64,
+        .flags          = V4L2_CTRL_FLAG_READ_ONLY | V4L2_CTRL_FLAG_VOLATILE,
+        .min            = 0,
+        .max            = U32_MAX,
+        .def            = 0,
+        .step           = 1,
+    },
+    {
+        .ops            = &daxc02_ctrl_ops,
+        .id             = DAXC02_CID_TARGET_FRAME,
+        .name           = "Target Frame",
+        .type           = V4L2_CTRL_TYPE_INTEGER64,
+        .flags          = V4L2_CTRL_FLAG_VOLATILE | V4L2_CTRL_FLAG_EXECUTE_ON_WRITE,
+        .min            = 0,
+        .max            = U32_MAX,
+        .def            = 0,
+        .step           = 1,
+    },
+    {
+        .ops            = &daxc02_ctrl_ops,
+        .id             = DAXC02_CID_CTRL_LATENCY,
+        .name           = "Control Latency",
+        .type           = V4L2_CTRL_TYPE_INTEGER,
+        .flags          = V4L2_CTRL_FLAG_READ_ONLY,
+        .min            = DAXC02_CTRL_LATENCY,
+        .max            = DAXC02_CTRL_LATENCY,
+        .def            = DAXC02_CTRL_LATENCY,
+        .step           = 1,
+    },
+    {
+        .ops            = &daxc02_ctrl_ops,
+        .id             = DAXC02_CID_GAIN_LATENCY,
+        .name           = "Gain Latency",
+        .type           = V4L2_CTRL_TYPE_INTEGER,
+        .flags          = V4L2_CTRL_FLAG_READ_ONLY,
+        .min            = DAXC02_GAIN_LATENCY,
+        .max            = DAXC02_GAIN_LATENCY,
+        .def            = DAXC02_GAIN_LATENCY,
+        .step           = 1,
+    },
+    {
+        .ops            = &daxc02_ctrl_ops,
+        .id             = DAXC02_CID_EXPOSURE_LATENCY,
+        .name           = "Exposure Latency",
+        .type           = V4L2_CTRL_TYPE_INTEGER,
+        .flags          = V4L2_CTRL_FLAG_READ_ONLY,
+        .min            = DAXC02_EXPOSURE_LATENCY,
+        .max            = DAXC02_EXPOSURE_LATENCY,
+        .def            = DAXC02_EXPOSURE_LATENCY,
+        .step           = 1,
+    },
+    {
+        .ops            = &daxc02_ctrl_ops,
+        .id             = DAXC02_CID_FRAME_RATE_LATENCY,
+        .name           = "Frame Rate Latency",
+        .type           = V4L2_CTRL_TYPE_INTEGER,
+        .flags          = V4L2_CTRL_FLAG_READ_ONLY,
+        .min            = DAXC02_FRAME_RATE_LATENCY,
+        .max            = DAXC02_FRAME_RATE_LATENCY,
+        .def            = DAXC02_FRAME_RATE_LATENCY,
+        .step           = 1,
+    },
+    {
+        .ops            = &daxc02_ctrl_ops,
+        .id             = DAXC02_CID_STEREO_LOCKSTEP,
+        .name           = "Stereo Lockstep",
+        .type           = V4L2_CTRL_TYPE_BOOLEAN,
+        .flags          = V4L2_CTRL_FLAG_READ_ONLY | V4L2_CTRL_FLAG_VOLATILE,
+        .min            = 0,
+        .max            = 1,
+        .def            = 0,
+        .step           = 1,
+    },
+    {
+        .ops            = &daxc02_ctrl_ops,
+        .id             = DAXC02_CID_SNAPSHOT_MODE,
+        .name           = "Snapshot Mode",
+        .type           = V4L2_CTRL_TYPE_BOOLEAN,
+        .min            = 0,
+        .max            = 1,
+        .def            = 0,
+        .step           = 1,
+    },
+    {
+        .ops            = &daxc02_ctrl_ops,
+        .id             = DAXC02_CID_SNAPSHOT_TRIGGER,
+        .name           = "Snapshot Trigger",
+        .type           = V4L2_CTRL_TYPE_BUTTON,
+        .min            = 0,
+        .max            = 0,
+        .def            = 0,
+        .step           = 0,
+    },
+    {
+        .ops            = &daxc02_ctrl_ops,
+        .id             = DAXC02_CID_LOW_LATENCY,
+        .name           = "Low Latency Readout",
+        .type           = V4L2_CTRL_TYPE_BOOLEAN,
+        .min            = 0,
+        .max            = 1,
+        .def            = 0,
+        .step           = 1,
+    },
+    {
+        .ops            = &daxc02_ctrl_ops,
+        .id             = DAXC02_CID_READOUT_TIME,
+        .name           = "Readout Time",
+        .type           = V4L2_CTRL_TYPE_INTEGER,
+        .flags          = V4L2_CTRL_FLAG_READ_ONLY | V4L2_CTRL_FLAG_VOLATILE,
+        .min            = 0,
+        .max            = S32_MAX,
+        .def            = 0,
+        .step           = 1,
+    },
+    {
+        .ops            = &daxc02_ctrl_ops,
+        .id             = DAXC02_CID_TEMPERATURE,
+        .name           = "Temperature",
+        .type           = V4L2_CTRL_TYPE_INTEGER,
+        .flags          = V4L2_CTRL_FLAG_READ_ONLY | V4L2_CTRL_FLAG_VOLATILE,
+        .min            = -40000,
+        .max            = 150000,
+        .def            = 0,
+        .step           = 1,
+    },
+    {
+        .ops            = &daxc02_ctrl_ops,
+        .id             = DAXC02_CID_EXPOSURE_ACTUAL,
+        .name           = "Exposure Actual",
+        .type           = V4L2_CTRL_TYPE_INTEGER64,
+        .flags          = V4L2_CTRL_FLAG_READ_ONLY | V4L2_CTRL_FLAG_VOLATILE,
+        .min            = 0,
+        .max            = 2 * FIXED_POINT_SCALING_FACTOR,
+        .def            = 0,
+        .step           = 1,
+    },
+    {
+        .ops            = &daxc02_ctrl_ops,
+        .id             = DAXC02_CID_FRAME_PERIOD,
+        .name           = "Frame Period",
+        .type           = V4L2_CTRL_TYPE_INTEGER,
+        .flags          = V4L2_CTRL_FLAG_READ_ONLY | V4L2_CTRL_FLAG_VOLATILE,
+        .min            = 0,
+        .max            = S32_MAX,
+        .def            = 0,
+        .step           = 1,
+    },
+    {
+        .ops            = &daxc02_ctrl_ops,
+        .id             = DAXC02_CID_LINE_TIME,
+        .name           = "Line Time",
+        .type           = V4L2_CTRL_TYPE_INTEGER,
+        .flags          = V4L2_CTRL_FLAG_READ_ONLY | V4L2_CTRL_FLAG_VOLATILE,
+        .min            = 0,
+        .max            = S32_MAX,
+        .def            = 0,
+        .step           = 1,
+    },
+    {
+        .ops            = &daxc02_ctrl_ops,
+        .id             = DAXC02_CID_EXPOSURE_TIMESTAMP,
+        .name           = "Exposure Timestamp",
+        .type           = V4L2_CTRL_TYPE_INTEGER64,
+        .flags          = V4L2_CTRL_FLAG_READ_ONLY | V4L2_CTRL_FLAG_VOLATILE,
+        .min            = 0,
+        .max            = S64_MAX,
+        .def            = 0,
+        .step           = 1,
+    },
 };
 
 
@@ -446,7 +1030,7 @@ static int daxc02_power_on(struct camera_common_data *s_data)
     if(ret) goto daxc02_iovdd_fail;
 
     msleep(30);
-    if(pw->reset_gpio) daxc02_gpio_set(priv, pw->reset_gpio, 1);
+    if(gpio_is_valid(pw->reset_gpio)) daxc02_gpio_set(priv, pw->reset_gpio, 1);
     msleep(200);
 
     pw->state = SWITCH_ON;
@@ -482,7 +1066,7 @@ static int daxc02_power_off(struct camera_common_data *s_data)
         return ret;
     }
 
-    if(pw->reset_gpio) daxc02_gpio_set(priv, pw->reset_gpio, 0);
+    if(gpio_is_valid(pw->reset_gpio)) daxc02_gpio_set(priv, pw->reset_gpio, 0);
     usleep_range(50, 100);
     if(pw->iovdd) regulator_disable(pw->iovdd);
     usleep_range(50, 100);
@@ -537,11 +1121,12 @@ static int daxc02_power_get(struct daxc02 *priv)
     /* IO 1.8v */
     ret |= camera_common_regulator_get(&client->dev, &pw->iovdd, pdata->regulators.iovdd);
 
-    if(!ret)
-    {
-        pw->reset_gpio = pdata->reset_gpio;
+    pw->reset_gpio = pdata->reset_gpio;
 
-        ret = gpio_request(pw->reset_gpio, "daxc02_reset");
+    /* sensors without a reset line are held out of reset by the board */
+    if(!ret && gpio_is_valid(pw->reset_gpio))
+    {
+        ret = devm_gpio_request(&client->dev, pw->reset_gpio, "daxc02_reset");
         if(ret < 0) dev_err(&client->dev, "%s: can't request reset_gpio %d\n", __func__, ret);
     }
 
@@ -563,7 +1148,7 @@ static inline int mt9m021_read(struct i2c_client *client, uint16_t addr, uint16_
     struct i2c_msg msg[2];
     uint8_t buf[2];
     uint16_t __addr;
-    uint16_t ret;
+    int ret;
 
     /* 16 bit addressable register */
     __addr = cpu_to_be16(addr);
@@ -582,6 +1167,7 @@ static inline int mt9m021_read(struct i2c_client *client, uint16_t addr, uint16_
     if(ret < 0)
     {
         dev_err(&client->dev, "read failed at 0x%04x error %d\n", addr, ret);
+        daxc02_error_event(client, DAXC02_EVENT_SRC_SENSOR, addr, ret);
         return ret;
     }
 
@@ -619,6 +1205,7 @@ static inline int mt9m021_write(struct i2c_client *client, uint16_t addr, uint16
     if(ret == 1) return 0;
 
     dev_err(&client->dev, "write failed at 0x%04x error %d\n", addr, ret);
+    daxc02_error_event(client, DAXC02_EVENT_SRC_SENSOR, addr, ret);
     return ret;
 }
 
@@ -644,86 +1231,363 @@ static int mt9m021_write_table(struct i2c_client *client, const struct reg_16 ta
     return ret;
 }
 
-/** daxc02_bridge_setup - Configures the MIPI bridge.
-  * @client: pointer to the i2c client.
+/** mt9m021_group_hold - holds or releases register updates.
+  * @priv:      pointer to the daxc02 struct.
+  * @hold:      true to hold, false to latch held registers on the next frame.
+  *
+  * Holds nest, only the outermost release latches the registers.
   */
-static int daxc02_bridge_setup(struct i2c_client *client)
+static int mt9m021_group_hold(struct daxc02 *priv, bool hold)
 {
-    struct i2c_msg msg[2];
-    uint8_t buf[6];
-    struct daxc02_mipi_settings settings;
-    int ret;
-    uint8_t i;
-
-    for(i = 0; i < ARRAY_SIZE(daxc02_buffer_config); i++)
+    /* a hold is counted even when its write fails, callers always release */
+    if(hold && priv->hold_count++) return 0;
+    if(!hold && priv->hold_count > 1)
     {
-        settings = daxc02_buffer_config[i];
+        priv->hold_count--;
+        return 0;
+    }
+    if(!hold) priv->hold_count = 0;
 
-        /* ADDR[15:8], ADDR[7:0] */
-        buf[0] = (uint8_t)(settings.addr >> 8);
-        buf[1] = (uint8_t)(settings.addr >> 0);
+    return mt9m021_write(priv->i2c_client, MT9M021_GROUPED_PARAM_HOLD,
+        hold ? MT9M021_GROUPED_HOLD_ON : MT9M021_GROUPED_HOLD_OFF);
+}
 
-        /* DATA[15:8], DATA[7:0] */
-        buf[2] = (uint8_t)(settings.data >> 8);
-        buf[3] = (uint8_t)(settings.data >> 0);
+/** daxc02_bridge_write - Writes a single MIPI bridge register.
+  * @client:    pointer to the i2c client.
+  * @settings:  register length, address and data to write.
+  */
+static int daxc02_bridge_write(struct i2c_client *client, const struct daxc02_mipi_settings *settings)
+{
+    struct i2c_msg msg;
+    uint8_t buf[6];
+    int ret;
 
-        /*DATA[31:24], DATA[23:16] */
-        buf[4] = (uint8_t)(settings.data >> 24);
-        buf[5] = (uint8_t)(settings.data >> 16);
+    /* ADDR[15:8], ADDR[7:0] */
+    buf[0] = (uint8_t)(settings->addr >> 8);
+    buf[1] = (uint8_t)(settings->addr >> 0);
 
-        msg[0].addr  = BRIDGE_I2C_ADDR;
-        msg[0].flags = 0;
-        msg[0].len   = settings.len + 2;
-        msg[0].buf   = buf;
+    /* DATA[15:8], DATA[7:0] */
+    buf[2] = (uint8_t)(settings->data >> 8);
+    buf[3] = (uint8_t)(settings->data >> 0);
 
-        ret = i2c_transfer(client->adapter, msg, 1);
+    /*DATA[31:24], DATA[23:16] */
+    buf[4] = (uint8_t)(settings->data >> 24);
+    buf[5] = (uint8_t)(settings->data >> 16);
 
-        if(ret < 0)
-        {
-            dev_err(&client->dev, "%s failed at 0x%04x error %d\n", __func__, settings.addr, ret);
-            break;
-        }
+    msg.addr  = BRIDGE_I2C_ADDR;
+    msg.flags = 0;
+    msg.len   = settings->len + 2;
+    msg.buf   = buf;
+
+    ret = i2c_transfer(client->adapter, &msg, 1);
+    if(ret < 0)
+    {
+        dev_err(&client->dev, "%s failed at 0x%04x error %d\n", __func__, settings->addr, ret);
+        daxc02_error_event(client, DAXC02_EVENT_SRC_BRIDGE, settings->addr, ret);
+        return ret;
+    }
+
+    return 0;
+}
+
+/** daxc02_bridge_read - Reads a single MIPI bridge register.
+  * @client: pointer to the i2c client.
+  * @len:    register length, 2 or 4 bytes.
+  * @addr:   register address.
+  * @data:   where to store the register value.
+  */
+static int daxc02_bridge_read(struct i2c_client *client, uint8_t len, uint16_t addr, uint32_t *data)
+{
+    struct i2c_msg msg[2];
+    uint8_t addr_buf[2];
+    uint8_t buf[4] = { 0 };
+    int ret;
+
+    /* ADDR[15:8], ADDR[7:0] */
+    addr_buf[0] = (uint8_t)(addr >> 8);
+    addr_buf[1] = (uint8_t)(addr >> 0);
+
+    msg[0].addr  = BRIDGE_I2C_ADDR;
+    msg[0].flags = 0;
+    msg[0].len   = 2;
+    msg[0].buf   = addr_buf;
+
+    msg[1].addr  = BRIDGE_I2C_ADDR;
+    msg[1].flags = I2C_M_RD;
+    msg[1].len   = len;
+    msg[1].buf   = buf;
+
+    ret = i2c_transfer(client->adapter, msg, 2);
+    if(ret < 0)
+    {
+        dev_err(&client->dev, "%s failed at 0x%04x error %d\n", __func__, addr, ret);
+        daxc02_error_event(client, DAXC02_EVENT_SRC_BRIDGE, addr, ret);
+        return ret;
+    }
+
+    /* DATA[15:8], DATA[7:0], DATA[31:24], DATA[23:16] */
+    *data = (buf[0] << 8) | buf[1] | (buf[2] << 24) | (buf[3] << 16);
+    return 0;
+}
+
+/** daxc02_bridge_faults - Reads and clears the bridge FIFO and CSI errors.
+  * @client:  pointer to the i2c client.
+  * @faulted: set if the parallel FIFO or CSI transmitter latched an error.
+  *
+  * A FIFO overflow or a halted transmitter stops frames reaching the Tegra
+  * while the sensor keeps counting them.
+  */
+static int daxc02_bridge_faults(struct i2c_client *client, bool *faulted)
+{
+    struct daxc02_mipi_settings clear;
+    uint32_t fifo, csi;
+    int ret;
+
+    ret = daxc02_bridge_read(client, 2, TC358746_FIFO_STATUS, &fifo);
+    if(!ret) ret = daxc02_bridge_read(client, 4, TC358746_CSI_ERR, &csi);
+    if(ret) return ret;
+
+    fifo &= TC358746_FIFO_ERRORS;
+    *faulted = fifo || csi;
+    if(!*faulted) return 0;
+
+    dev_dbg(&client->dev, "%s: fifo 0x%04x csi 0x%08x\n", __func__, fifo, csi);
+
+    clear.len = 2;
+    clear.addr = TC358746_FIFO_STATUS;
+    clear.data = fifo;
+    ret = daxc02_bridge_write(client, &clear);
+    if(ret) return ret;
+
+    clear.len = 4;
+    clear.addr = TC358746_CSI_ERR;
+    clear.data = csi;
+    return daxc02_bridge_write(client, &clear);
+}
+
+/** daxc02_bridge_data - Picks the value for a bridge register.
+  * @addr:      bridge register address.
+  * @data:      value from the full rate table.
+  * @low_clock: the sensor runs at MT9M021_TARGET_FREQ_LOW.
+  */
+static uint32_t daxc02_bridge_data(uint16_t addr, uint32_t data, bool low_clock)
+{
+    uint8_t i;
+
+    if(!low_clock) return data;
+
+    for(i = 0; i < ARRAY_SIZE(daxc02_buffer_low_clock); i++)
+    {
+        if(daxc02_buffer_low_clock[i].addr == addr) return daxc02_buffer_low_clock[i].data;
+    }
+
+    return data;
+}
+
+/** daxc02_bridge_setup - Configures the MIPI bridge.
+  * @client:    pointer to the i2c client.
+  * @low_clock: scale the CSI PLL and lane timing for MT9M021_TARGET_FREQ_LOW.
+  */
+static int daxc02_bridge_setup(struct i2c_client *client, bool low_clock)
+{
+    struct daxc02_mipi_settings setting;
+    int ret = 0;
+    uint8_t i;
+
+    for(i = 0; i < ARRAY_SIZE(daxc02_buffer_config); i++)
+    {
+        setting = daxc02_buffer_config[i];
+        setting.data = daxc02_bridge_data(setting.addr, setting.data, low_clock);
+
+        ret = daxc02_bridge_write(client, &setting);
+        if(ret < 0) break;
+    }
+
+    return ret;
+}
+
+/** daxc02_bridge_restart - Restarts the MIPI bridge CSI transmitter.
+  * @client: pointer to the i2c client.
+  */
+static int daxc02_bridge_restart(struct i2c_client *client)
+{
+    int ret = 0;
+    uint8_t i;
+
+    for(i = 0; i < ARRAY_SIZE(daxc02_buffer_restart); i++)
+    {
+        ret = daxc02_bridge_write(client, &daxc02_buffer_restart[i]);
+        if(ret < 0) break;
     }
 
     return ret;
 }
 
-/** mt9m021_set_gain - sets the digital gain.
+/** mt9m021_set_gain - sets the total gain.
  * @priv: pointer to the daxc02 struct.
  * @value: gain in Q42.22 format.
+ *
+ * The column (analog) gain is raised first and the remainder is made up with
+ * the digital global gain.  Both are latched together on the next frame.
  */
 static int mt9m021_set_gain(struct daxc02 *priv, int64_t value)
 {
-    uint16_t gain = (value / (1 << 17));
-    uint16_t integer_gain = (gain >> 5);
-    uint16_t fractional_gain = (gain % (1<<5));
+    struct i2c_client *client = priv->i2c_client;
+    uint32_t gain = (value / (1 << 17));
+    uint16_t analog = MT9M021_ANALOGUE_GAIN_MIN;
+    uint16_t digital;
+    uint16_t reg16;
+    int ret, hold_ret;
+
+    while(analog < MT9M021_ANALOGUE_GAIN_MAX &&
+          gain >= (MT9M021_DIGITAL_GAIN_UNITY << (analog + 1)))
+        analog++;
 
-    dev_dbg(&priv->i2c_client->dev, "%s: %u + %u/32\n", __func__, integer_gain, fractional_gain);
+    digital = clamp_t(uint32_t, DIV_ROUND_CLOSEST(gain, 1 << analog),
+        MT9M021_DIGITAL_GAIN_UNITY, MT9M021_DIGITAL_GAIN_MAX);
 
-    return mt9m021_write(priv->i2c_client, MT9M021_GLOBAL_GAIN, gain);
+    dev_dbg(&client->dev, "%s: %ux column, %u + %u/32 digital\n", __func__,
+        1 << analog, digital >> 5, digital % (1 << 5));
+
+    ret = mt9m021_read(client, MT9M021_DIGITAL_TEST, &reg16);
+    if(ret) return ret;
+
+    reg16 &= ~MT9M021_ANALOGUE_GAIN_MASK;
+    reg16 |= ((analog << MT9M021_ANALOGUE_GAIN_SHIFT) & MT9M021_ANALOGUE_GAIN_MASK);
+
+    ret = mt9m021_group_hold(priv, true);
+    if(!ret) ret = mt9m021_write(client, MT9M021_DIGITAL_TEST, reg16);
+    if(!ret) ret = mt9m021_write(client, MT9M021_GLOBAL_GAIN, digital);
+    if(!ret) priv->gain = digital << analog;
+
+    hold_ret = mt9m021_group_hold(priv, false);
+    return ret ? ret : hold_ret;
 }
 
-/** mt9m021_set_exposure - sets the integration time.
+/** mt9m021_line_length - gets the line length in pixel clocks.
  * @priv: pointer to the daxc02 struct.
- * @value: exposure seconds in Q42.22 format.
+ *
+ * Low latency readout runs at the shortest line the sensor supports instead
+ * of the line length the device tree gives the mode.
  */
-static int mt9m021_set_exposure(struct daxc02 *priv, int64_t value)
+static uint32_t mt9m021_line_length(struct daxc02 *priv)
+{
+    if(priv->low_latency) return MT9M021_LLP_MIN;
+
+    return priv->mode_line_length[priv->s_data->mode];
+}
+
+/** mt9m021_frame_length - converts a frame rate to frame length lines.
+ * @priv:       pointer to the daxc02 struct.
+ * @frame_rate: frame rate in Q42.22 format.
+ */
+static uint32_t mt9m021_frame_length(struct daxc02 *priv, int64_t frame_rate)
+{
+    uint64_t frame_length;
+
+    if(frame_rate <= 0) return MT9M021_FRAME_LENGTH_MAX;
+
+    frame_length = div64_u64(priv->timing.line_rate * FIXED_POINT_SCALING_FACTOR, frame_rate) >>
+        DAXC02_LINE_RATE_SHIFT;
+
+    return clamp_t(uint64_t, frame_length, 1, MT9M021_FRAME_LENGTH_MAX);
+}
+
+/** mt9m021_exposure - converts lines to an exposure time.
+ * @priv:  pointer to the daxc02 struct.
+ * @lines: integration time in lines.
+ *
+ * Returns seconds in Q42.22 format.
+ */
+static int64_t mt9m021_exposure(struct daxc02 *priv, uint32_t lines)
+{
+    return div64_u64((uint64_t)lines * priv->timing.line_time_ps * FIXED_POINT_SCALING_FACTOR, DAXC02_PS_PER_SEC);
+}
+
+/** daxc02_timing_update - precomputes the timing model for the current mode.
+ * @priv:           pointer to the daxc02 struct.
+ * @min_frame_rate: slowest frame rate in Q42.22 format, sets the longest frame.
+ * @max_frame_rate: fastest frame rate in Q42.22 format, sets the shortest frame.
+ */
+static void daxc02_timing_update(struct daxc02 *priv, int64_t min_frame_rate, int64_t max_frame_rate)
 {
     struct camera_common_data *s_data = priv->s_data;
+    struct sensor_mode_properties *mode = &s_data->sensor_props.sensor_modes[s_data->mode];
+    struct daxc02_timing *timing = &priv->timing;
+    int64_t dt_max_exposure;
+
+    timing->pix_clk = mode->signal_properties.pixel_clock.val;
+    timing->line_length = mt9m021_line_length(priv);
+    timing->line_rate = div_u64((uint64_t)timing->pix_clk << DAXC02_LINE_RATE_SHIFT, timing->line_length);
+    timing->line_time_ps = (uint32_t)div_u64((uint64_t)timing->line_length * DAXC02_PS_PER_SEC, timing->pix_clk);
+
+    timing->min_frame_length = mt9m021_frame_length(priv, max_frame_rate);
+    timing->max_frame_length = mt9m021_frame_length(priv, min_frame_rate);
+
+    /* longest exposure is one frame at the minimum frame rate */
+    timing->max_exposure = mt9m021_exposure(priv, timing->max_frame_length - MT9M021_COARSE_TIME_MARGIN);
+
+    /* and never past the mode's max_exp_time, so the control agrees with what VI was told */
+    dt_max_exposure = div_u64(mode->control_properties.max_exp_time.val * FIXED_POINT_SCALING_FACTOR, 1000000);
+    if(dt_max_exposure) timing->max_exposure = min_t(int64_t, timing->max_exposure, dt_max_exposure);
+
+    dev_dbg(&priv->i2c_client->dev, "%s: line %u ps, frame %u-%u lines\n", __func__,
+        timing->line_time_ps, timing->min_frame_length, timing->max_frame_length);
+}
+
+/** mt9m021_set_vfr - programs the integration time and frame length together.
+ * @priv:        pointer to the daxc02 struct.
+ * @coarse_time: integration time in lines.
+ *
+ * The frame is stretched past the requested frame rate when the integration
+ * time needs it, and shrinks back to the requested rate once it fits again.
+ */
+static int mt9m021_set_vfr(struct daxc02 *priv, uint32_t coarse_time)
+{
+    struct i2c_client *client = priv->i2c_client;
+    uint32_t frame_length;
+    int ret;
+
+    coarse_time = clamp_t(uint32_t, coarse_time, 1,
+        MT9M021_FRAME_LENGTH_MAX - MT9M021_COARSE_TIME_MARGIN);
+
+    frame_length = max_t(uint32_t, priv->frame_length_req,
+        coarse_time + MT9M021_COARSE_TIME_MARGIN);
 
-    const struct sensor_mode_properties *mode =
-        &s_data->sensor_props.sensor_modes[s_data->mode];
+    /* grow the frame before lengthening integration */
+    if(frame_length > priv->frame_length)
+    {
+        ret = mt9m021_write(client, MT9M021_FRAME_LENGTH_LINES, frame_length);
+        if(ret) return ret;
+        priv->frame_length = frame_length;
+    }
+
+    ret = mt9m021_write(client, MT9M021_COARSE_INT_TIME, coarse_time);
+    if(ret) return ret;
+    priv->coarse_time = coarse_time;
+
+    /* and shrink it after shortening integration */
+    if(frame_length < priv->frame_length)
+    {
+        ret = mt9m021_write(client, MT9M021_FRAME_LENGTH_LINES, frame_length);
+        if(ret) return ret;
+        priv->frame_length = frame_length;
+    }
+
+    dev_dbg(&client->dev, "%s: coarse 0x%04x frame 0x%04x\n", __func__, priv->coarse_time, priv->frame_length);
+    return 0;
+}
 
-    int64_t coarse_time64 = 
-        value *
-        mode->signal_properties.pixel_clock.val /
-        mode->image_properties.line_length / 
-        FIXED_POINT_SCALING_FACTOR;
-    
-    priv->coarse_time = (uint16_t)(coarse_time64);
+/** mt9m021_set_exposure - sets the integration time.
+ * @priv: pointer to the daxc02 struct.
+ * @value: exposure seconds in Q42.22 format.
+ */
+static int mt9m021_set_exposure(struct daxc02 *priv, int64_t value)
+{
+    uint64_t coarse_time = ((uint64_t)max_t(int64_t, value, 0) * priv->timing.line_rate /
+        FIXED_POINT_SCALING_FACTOR) >> DAXC02_LINE_RATE_SHIFT;
 
-    dev_dbg(&priv->i2c_client->dev, "%s: 0x%04x\n", __func__, priv->coarse_time);
-    return mt9m021_write(priv->i2c_client, MT9M021_COARSE_INT_TIME, priv->coarse_time);
+    return mt9m021_set_vfr(priv, min_t(uint64_t, coarse_time, MT9M021_FRAME_LENGTH_MAX));
 }
 
 /** mt9m021_set_frame_rate - sets the frames per second.
@@ -732,23 +1596,18 @@ static int mt9m021_set_exposure(struct daxc02 *priv, int64_t value)
  */
 static int mt9m021_set_frame_rate(struct daxc02 *priv, int64_t value)
 {
-    struct camera_common_data *s_data = priv->s_data;
-
-    const struct sensor_mode_properties *mode =
-        &s_data->sensor_props.sensor_modes[s_data->mode];
+    /* a stereo secondary runs at its primary's cap */
+    int64_t cap = priv->stereo_primary ?
+        priv->stereo_primary->frame_rate_cap : priv->frame_rate_cap;
 
-    int64_t frame_length64 = 
-        mode->signal_properties.pixel_clock.val *
-        FIXED_POINT_SCALING_FACTOR /
-        value;
+    priv->frame_rate = value;
+    if(cap) value = min_t(int64_t, value, cap);
 
-    frame_length64 -= (mode->image_properties.width + 12);
-    frame_length64 /= mode->image_properties.line_length;
+    priv->frame_length_req = clamp_t(uint32_t, mt9m021_frame_length(priv, value),
+        priv->timing.min_frame_length, priv->timing.max_frame_length);
 
-    priv->frame_length = (uint16_t)(frame_length64 - 1);
-
-    dev_dbg(&priv->i2c_client->dev, "%s: 0x%04x\n", __func__, priv->frame_length);
-    return mt9m021_write(priv->i2c_client, MT9M021_FRAME_LENGTH_LINES, priv->frame_length);
+    dev_dbg(&priv->i2c_client->dev, "%s: 0x%04x\n", __func__, priv->frame_length_req);
+    return mt9m021_set_vfr(priv, priv->coarse_time);
 }
 
 /** mt9m021_set_flash - enables or disables flash.
@@ -784,202 +1643,1931 @@ static int mt9m021_set_flash(struct i2c_client *client, enum v4l2_flash_led_mode
     return ret;
 }
 
+/** mt9m021_snapshot - reads out a single frame while armed in trigger mode.
+ * @priv: pointer to the daxc02 struct.
+ *
+ * Standby at end of frame is set in trigger mode, so pulsing the stream bit
+ * exposes and reads out exactly one frame before the sensor drops back to
+ * standby.  A bound stereo secondary in snapshot mode fires with it.
+ */
+static int mt9m021_snapshot(struct daxc02 *priv)
+{
+    struct i2c_client *client = priv->i2c_client;
+    struct daxc02 *secondary = priv->stereo_secondary;
+    uint16_t status;
+    int ret, err;
+
+    if(!priv->streaming || !priv->snapshot) return -EBUSY;
+
+    ret = mt9m021_read(client, MT9M021_FRAME_STATUS, &status);
+    if(ret) return ret;
+
+    /* the previous frame is still being read out */
+    if(!(status & MT9M021_FRAME_STATUS_STANDBY)) return -EBUSY;
+
+    if(secondary && !(secondary->streaming && secondary->snapshot)) secondary = NULL;
+
+    ret = mt9m021_write(client, MT9M021_RESET_REG, MT9M021_TRIGGER_STREAM);
+    if(!ret && secondary) ret = mt9m021_write(secondary->i2c_client, MT9M021_RESET_REG, MT9M021_TRIGGER_STREAM);
+
+    /* always rearm, but report the first failure */
+    err = mt9m021_write(client, MT9M021_RESET_REG, MT9M021_TRIGGER_MODE);
+    if(!ret) ret = err;
+
+    if(secondary)
+    {
+        err = mt9m021_write(secondary->i2c_client, MT9M021_RESET_REG, MT9M021_TRIGGER_MODE);
+        if(!ret) ret = err;
+    }
+
+    if(ret) return ret;
+
+    priv->stats.snapshots++;
+    return 0;
+}
+
 /***************************************************
         V4L2 Subdev Video Operations
 ****************************************************/
 
-/** mt9m021_s_stream - starts or disables streaming.
- * @sd:     pointer to the v4l2 sub-device.
- * @enable: enable or disable stream.
+/** daxc02_start_stream - Configures the bridge and sensor and starts streaming.
+ * @priv: pointer to the daxc02 struct.
  */
-static int mt9m021_s_stream(struct v4l2_subdev *sd, int enable)
+static int daxc02_start_stream(struct daxc02 *priv)
 {
-    struct i2c_client *client = v4l2_get_subdevdata(sd);
-    struct camera_common_data *s_data = to_camera_common_data(&client->dev);
-    struct daxc02 *priv = (struct daxc02 *)s_data->priv;
+    struct i2c_client *client = priv->i2c_client;
+    struct camera_common_data *s_data = priv->s_data;
     struct v4l2_ext_controls ctrls;
     struct v4l2_ext_control control[3];
-    int ret;
+    struct v4l2_ctrl *ctrl;
+    bool low_clock;
+    unsigned int i;
+    int pattern;
+    int ret, err;
+
+    /* the sensor registers no longer match the cached timing */
+    priv->frame_length = 0;
+
+    /* the bridge lane rate follows the mode's pixel clock */
+    low_clock = priv->timing.pix_clk <= MT9M021_TARGET_FREQ_LOW;
+    if(priv->fw) ret = daxc02_fw_replay(client, low_clock ? &priv->fw->bridge_low_clock : &priv->fw->bridge);
+    else ret = daxc02_bridge_setup(client, low_clock);
+    if(ret < 0)
+    {
+        dev_err(&client->dev, "%s: Failed to setup mipi bridge\n", __func__);
+        return ret;
+    }
 
-    dev_dbg(&client->dev, "%s\n", __func__);
+    if(priv->fw) ret = daxc02_fw_replay(client, &priv->fw->common);
+    else ret = mt9m021_write_table(client, daxc02_mode_table_common);
+    if(ret < 0)
+    {
+        dev_err(&client->dev, "%s: failed to configure mt9m021.\n", __func__);
+        return ret;
+    }
 
-    if(!enable)
+    if(priv->fw) ret = daxc02_fw_replay(client, &priv->fw->modes[s_data->mode]);
+    else ret = mt9m021_write_table(client, mode_table[s_data->mode]);
+    if(ret < 0)
     {
-        dev_info(&client->dev, "Ending stream\n");
-        return mt9m021_write(client, MT9M021_RESET_REG, MT9M021_STREAM_OFF);
+        dev_err(&client->dev, "%s: failed to set mode.\n", __func__);
+        return ret;
     }
-    else dev_info(&client->dev, "Starting stream in mode %d\n", priv->s_data->mode);
 
-    ret = daxc02_bridge_setup(client);
-    if(ret < 0)
-    {
-        dev_err(&client->dev, "%s: Failed to setup mipi bridge\n", __func__);
-        return ret;
-    }
+    /* shortest line and fastest readout, before the timing math below uses them */
+    if(priv->low_latency)
+    {
+        ret = mt9m021_write(client, MT9M021_LINE_LENGTH_PCK, MT9M021_LLP_MIN);
+        if(!ret) ret = mt9m021_write(client, MT9M021_READ_SPEED, MT9M021_READ_SPEED_FAST);
+        if(ret < 0)
+        {
+            dev_err(&client->dev, "%s: failed to set low latency readout.\n", __func__);
+            return ret;
+        }
+    }
+
+    /* the pattern is lost on power off, restore it for link tests */
+    ctrl = v4l2_ctrl_find(&priv->ctrl_handler, V4L2_CID_TEST_PATTERN);
+    pattern = ctrl ? v4l2_ctrl_g_ctrl(ctrl) : 0;
+    if(pattern)
+    {
+        ret = mt9m021_write(client, MT9M021_TEST_PATTERN, mt9m021_test_pattern_val[pattern]);
+        if(ret < 0)
+        {
+            dev_err(&client->dev, "%s: failed to set test pattern.\n", __func__);
+            return ret;
+        }
+    }
+
+    if(thermal_interval_ms && daxc02_temp_start(priv))
+        dev_warn(&client->dev, "%s: temperature sensor unavailable\n", __func__);
+
+    /* the strobe is lost on power off, restore it for exposure timestamps */
+    ctrl = priv->strobe_irq ? v4l2_ctrl_find(&priv->ctrl_handler, V4L2_CID_FLASH_LED_MODE) : NULL;
+    if(ctrl)
+    {
+        ret = mt9m021_set_flash(client, (enum v4l2_flash_led_mode)v4l2_ctrl_g_ctrl(ctrl));
+        if(ret < 0)
+        {
+            dev_err(&client->dev, "%s: failed to set strobe.\n", __func__);
+            return ret;
+        }
+    }
+
+    if(s_data->override_enable)
+    {
+        memset(&ctrls, 0, sizeof(ctrls));
+        ctrls.ctrl_class = V4L2_CTRL_ID2CLASS(TEGRA_CAMERA_CID_GAIN);
+        ctrls.count = 3;
+        ctrls.controls = control;
+
+        control[0].id = TEGRA_CAMERA_CID_GAIN;
+        control[1].id = TEGRA_CAMERA_CID_FRAME_RATE;
+        control[2].id = TEGRA_CAMERA_CID_EXPOSURE;
+
+        /* a stereo secondary starts from its primary's settings */
+        ret = v4l2_g_ext_ctrls(priv->stereo_primary ?
+            &priv->stereo_primary->ctrl_handler : &priv->ctrl_handler, &ctrls);
+        if(ret == 0)
+        {
+            /* serialize with daxc02_s_ctrl */
+            mutex_lock(priv->ctrl_handler.lock);
+
+            ret = mt9m021_set_gain(priv, control[0].value64);
+            if(ret) dev_err(&client->dev, "%s: error gain override\n", __func__);
+
+            err = mt9m021_set_frame_rate(priv, control[1].value64);
+            if(err) dev_err(&client->dev, "%s: error frame length override\n", __func__);
+            if(!ret) ret = err;
+
+            err = mt9m021_set_exposure(priv, control[2].value64);
+            if(err) dev_err(&client->dev, "%s: error exposure override\n", __func__);
+            if(!ret) ret = err;
+
+            for(i = 0; !ret && priv->stereo_primary && i < ARRAY_SIZE(control); i++)
+                daxc02_stereo_cache(priv, control[i].id, control[i].value64);
+
+            mutex_unlock(priv->ctrl_handler.lock);
+        }
+        else dev_err(&client->dev, "%s: failed to get overrides\n", __func__);
+    }
+
+    /* a reinitialized sensor may have reset its counter, number on from here */
+    daxc02_frame_seq_rebase(priv);
+
+    /* the first pulse exposes the frame after the current one */
+    daxc02_strobe_arm(priv, true);
+
+    /* start streaming, or arm in standby for snapshots */
+    ret = mt9m021_write(client, MT9M021_RESET_REG,
+        priv->snapshot ? MT9M021_TRIGGER_MODE : MT9M021_MASTER_MODE);
+
+    return ret;
+}
+
+/** daxc02_frame_period_us - gets the current frame period.
+ * @priv: pointer to the daxc02 struct.
+ */
+static unsigned int daxc02_frame_period_us(struct daxc02 *priv)
+{
+    struct camera_common_data *s_data = priv->s_data;
+
+    if(!priv->frame_length)
+        return 1000000 / s_data->frmfmt[s_data->mode].framerates[0];
+
+    return (unsigned int)div_u64((uint64_t)priv->frame_length * priv->timing.line_time_ps, 1000000);
+}
+
+/** daxc02_readout_time_us - gets the time to read out the active lines.
+ * @priv: pointer to the daxc02 struct.
+ */
+static unsigned int daxc02_readout_time_us(struct daxc02 *priv)
+{
+    struct camera_common_data *s_data = priv->s_data;
+
+    return (unsigned int)div_u64((uint64_t)s_data->sensor_props.sensor_modes[s_data->mode].image_properties.height *
+        priv->timing.line_time_ps, 1000000);
+}
+
+/** daxc02_recover - attempts to restart a stalled stream.
+ * @priv:  pointer to the daxc02 struct.
+ * @level: escalation level, see DAXC02_RECOVER_*.
+ */
+static int daxc02_recover(struct daxc02 *priv, int level)
+{
+    struct i2c_client *client = priv->i2c_client;
+    int ret;
+
+    switch(level)
+    {
+        case DAXC02_RECOVER_BRIDGE:
+            dev_warn(&client->dev, "stream stalled, restarting bridge\n");
+            priv->stats.bridge_restarts++;
+            ret = daxc02_bridge_restart(client);
+            break;
+
+        case DAXC02_RECOVER_STREAM:
+            dev_warn(&client->dev, "stream stalled, restarting sensor\n");
+            priv->stats.stream_restarts++;
+            ret = mt9m021_write(client, MT9M021_RESET_REG, MT9M021_STREAM_OFF);
+            if(!ret) ret = mt9m021_write(client, MT9M021_RESET_REG, MT9M021_MASTER_MODE);
+            break;
+
+        default:
+            dev_warn(&client->dev, "stream stalled, reinitializing\n");
+            priv->stats.reinits++;
+            ret = daxc02_start_stream(priv);
+            break;
+    }
+
+    return ret;
+}
+
+/** daxc02_monitor_schedule - queues the next frame counter check.
+ * @priv: pointer to the daxc02 struct.
+ */
+static void daxc02_monitor_schedule(struct daxc02 *priv)
+{
+    unsigned int interval_us = max_t(unsigned int,
+        DAXC02_WATCHDOG_FRAMES * daxc02_frame_period_us(priv),
+        DAXC02_WATCHDOG_MIN_US);
+
+    schedule_delayed_work(&priv->monitor, usecs_to_jiffies(interval_us << priv->reinit_count));
+}
+
+/** daxc02_monitor - watches the sensor frame counter and bridge errors while streaming.
+ * @work: pointer to the monitor work struct.
+ *
+ * A stalled sensor counter skips the bridge restart, which cannot help.
+ * A bridge fault with the sensor still counting starts with it.  Reinits
+ * back off exponentially, and after DAXC02_WATCHDOG_MAX_REINITS the watchdog
+ * reports an error and stops until the next stream on.
+ */
+static void daxc02_monitor(struct work_struct *work)
+{
+    struct daxc02 *priv = container_of(to_delayed_work(work), struct daxc02, monitor);
+    struct i2c_client *client = priv->i2c_client;
+    struct daxc02_event_data data = { 0 };
+    bool sensor_stalled = true;
+    bool bridge_faulted = false;
+    uint16_t frame_count;
+    int first_level;
+    int ret;
+
+    mutex_lock(&priv->lock);
+
+    if(!priv->streaming) goto unlock;
+
+    ret = mt9m021_read(client, MT9M021_FRAME_COUNT, &frame_count);
+    if(!ret)
+    {
+        daxc02_frame_seq_update(priv, frame_count);
+        sensor_stalled = priv->frame_seq == priv->watchdog_seq;
+    }
+
+    if(!daxc02_bridge_faults(client, &bridge_faulted) && bridge_faulted) priv->stats.bridge_faults++;
+
+    if(!sensor_stalled && !bridge_faulted)
+    {
+        if(priv->stall_level)
+        {
+            dev_info(&client->dev, "stream recovered at level %d\n", priv->stall_level);
+            priv->stats.recovered++;
+
+            data.frame = priv->frame_seq;
+            data.id = priv->stall_level;
+            data.value = 1;
+            data.source = priv->stall_source;
+            daxc02_queue_event(client, DAXC02_EVENT_RECOVERY, &data);
+        }
+
+        priv->watchdog_seq = priv->frame_seq;
+        priv->stall_level = DAXC02_RECOVER_NONE;
+        priv->reinit_count = 0;
+    }
+    else if(watchdog)
+    {
+        if(priv->stall_level == DAXC02_RECOVER_NONE)
+        {
+            priv->stats.stalls++;
+            priv->stall_source = sensor_stalled ? DAXC02_EVENT_SRC_SENSOR : DAXC02_EVENT_SRC_BRIDGE;
+        }
+
+        first_level = sensor_stalled ? DAXC02_RECOVER_STREAM : DAXC02_RECOVER_BRIDGE;
+        if(priv->stall_level < first_level) priv->stall_level = first_level;
+        else if(priv->stall_level < DAXC02_RECOVER_REINIT) priv->stall_level++;
+
+        if(priv->stall_level == DAXC02_RECOVER_REINIT)
+        {
+            if(priv->reinit_count == DAXC02_WATCHDOG_MAX_REINITS)
+            {
+                dev_err(&client->dev, "stream did not recover after %u reinits, giving up\n", priv->reinit_count);
+                daxc02_error_event(client, priv->stall_source, priv->stall_source == DAXC02_EVENT_SRC_SENSOR ?
+                    MT9M021_FRAME_COUNT : TC358746_CSI_ERR, -ETIMEDOUT);
+                goto unlock;
+            }
+            priv->reinit_count++;
+        }
+
+        data.frame = priv->frame_seq;
+        data.id = priv->stall_level;
+        data.source = sensor_stalled ? DAXC02_EVENT_SRC_SENSOR : DAXC02_EVENT_SRC_BRIDGE;
+        daxc02_queue_event(client, DAXC02_EVENT_RECOVERY, &data);
+
+        ret = daxc02_recover(priv, priv->stall_level);
+        if(ret) dev_err(&client->dev, "%s: recovery failed %d\n", __func__, ret);
+
+        /* a restarted sensor may have reset its counter */
+        daxc02_frame_seq_sync(priv);
+        priv->watchdog_seq = priv->frame_seq;
+    }
+
+    daxc02_monitor_schedule(priv);
+
+    unlock:
+        mutex_unlock(&priv->lock);
+}
+
+/** daxc02_frame_seq_update - extends the 16-bit sensor frame counter.
+ * @priv:        pointer to the daxc02 struct.
+ * @frame_count: latest value of the sensor frame counter.
+ */
+static void daxc02_frame_seq_update(struct daxc02 *priv, uint16_t frame_count)
+{
+    unsigned long flags;
+
+    spin_lock_irqsave(&priv->queue_lock, flags);
+    priv->frame_seq += (uint16_t)(frame_count - priv->frame_count);
+    priv->frame_count = frame_count;
+    spin_unlock_irqrestore(&priv->queue_lock, flags);
+}
+
+/** daxc02_frame_seq_rebase - restarts counting from the sensor frame counter.
+ * @priv: pointer to the daxc02 struct.
+ *
+ * The sequence keeps its value, only the counter it extends is re-read.
+ */
+static void daxc02_frame_seq_rebase(struct daxc02 *priv)
+{
+    unsigned long flags;
+    uint16_t frame_count;
+
+    if(mt9m021_read(priv->i2c_client, MT9M021_FRAME_COUNT, &frame_count)) frame_count = 0;
+
+    spin_lock_irqsave(&priv->queue_lock, flags);
+    priv->frame_count = frame_count;
+    spin_unlock_irqrestore(&priv->queue_lock, flags);
+}
+
+/** daxc02_frame_seq_sync - reads the sensor frame counter into the frame sequence.
+ * @priv: pointer to the daxc02 struct.
+ */
+static void daxc02_frame_seq_sync(struct daxc02 *priv)
+{
+    uint16_t frame_count;
+
+    if(!mt9m021_read(priv->i2c_client, MT9M021_FRAME_COUNT, &frame_count))
+        daxc02_frame_seq_update(priv, frame_count);
+}
+
+/** daxc02_ctrl_latency - gets the frames until a control takes effect.
+ * @id: control id.
+ */
+static int32_t daxc02_ctrl_latency(uint32_t id)
+{
+    unsigned int i;
+
+    for(i = 0; i < ARRAY_SIZE(daxc02_ctrl_latencies); i++)
+    {
+        if(daxc02_ctrl_latencies[i].id == id) return daxc02_ctrl_latencies[i].frames;
+    }
+
+    return DAXC02_CTRL_LATENCY;
+}
+
+/** daxc02_apply_ctrl - writes a frame timing control to the sensor.
+ * @priv:  pointer to the daxc02 struct.
+ * @id:    control id.
+ * @value: control value in Q42.22 format.
+ */
+static int daxc02_apply_ctrl(struct daxc02 *priv, uint32_t id, int64_t value)
+{
+    switch(id)
+    {
+        case TEGRA_CAMERA_CID_GAIN:
+            return mt9m021_set_gain(priv, value);
+        case TEGRA_CAMERA_CID_EXPOSURE:
+            return mt9m021_set_exposure(priv, value);
+        case TEGRA_CAMERA_CID_FRAME_RATE:
+            return mt9m021_set_frame_rate(priv, value);
+    }
+
+    return -EINVAL;
+}
+
+/** daxc02_apply_ctrls - writes frame timing controls so they latch on the same frame.
+ * @priv:  pointer to the daxc02 struct.
+ * @ctrls: controls to write.
+ * @count: number of controls.
+ *
+ * When a stereo secondary is bound and streaming, both sensors are held and
+ * every control is mirrored to it, so the pair latches on the same frame
+ * boundary.
+ */
+static int daxc02_apply_ctrls(struct daxc02 *priv, const struct daxc02_queued_ctrl *ctrls, unsigned int count)
+{
+    struct daxc02 *secondary = priv->stereo_secondary;
+    struct daxc02_event_data data = { 0 };
+    unsigned int i;
+    int ret, err;
+
+    if(secondary && !secondary->streaming) secondary = NULL;
+
+    /* primary handler lock first, see daxc02_stereo_bind */
+    if(secondary) mutex_lock_nested(secondary->ctrl_handler.lock, SINGLE_DEPTH_NESTING);
+
+    ret = mt9m021_group_hold(priv, true);
+    if(!ret && secondary) ret = mt9m021_group_hold(secondary, true);
+
+    for(i = 0; !ret && i < count; i++)
+    {
+        ret = daxc02_apply_ctrl(priv, ctrls[i].id, ctrls[i].value);
+        if(!ret && secondary) ret = daxc02_apply_ctrl(secondary, ctrls[i].id, ctrls[i].value);
+    }
+
+    /* sample the frame right before the release latches the writes */
+    if(!ret && priv->streaming) daxc02_frame_seq_sync(priv);
+
+    /* always release, but report the first failure */
+    err = mt9m021_group_hold(priv, false);
+    if(!ret) ret = err;
+
+    if(secondary)
+    {
+        err = mt9m021_group_hold(secondary, false);
+        if(!ret) ret = err;
+
+        for(i = 0; !ret && i < count; i++)
+            daxc02_stereo_cache(secondary, ctrls[i].id, ctrls[i].value);
+
+        mutex_unlock(secondary->ctrl_handler.lock);
+    }
+
+    for(i = 0; !ret && i < count; i++)
+    {
+        data.frame = priv->frame_seq + daxc02_ctrl_latency(ctrls[i].id);
+        data.id = ctrls[i].id;
+        data.value = ctrls[i].value;
+        daxc02_queue_event(priv->i2c_client, DAXC02_EVENT_CTRL_APPLIED, &data);
+    }
+
+    return ret;
+}
+
+/** daxc02_submit_ctrl - applies a control now or queues it for its target frame.
+ * @priv:  pointer to the daxc02 struct.
+ * @id:    control id.
+ * @value: control value in Q42.22 format.
+ *
+ * Controls are queued while the Target Frame control is set and that frame
+ * is further away than the control's latency.  The target is cleared once
+ * its frame is reached, so later writes go back to applying immediately.
+ */
+static int daxc02_submit_ctrl(struct daxc02 *priv, uint32_t id, int64_t value)
+{
+    struct daxc02_queued_ctrl ctrl = { .id = id, .value = value };
+    struct daxc02_queued_ctrl *entry;
+    int32_t latency = daxc02_ctrl_latency(id);
+    unsigned long flags;
+    int32_t distance;
+
+    /* a bound secondary only follows its primary, see daxc02_stereo_cache */
+    if(priv->stereo_primary)
+    {
+        if(priv->stereo_sync) return 0;
+
+        dev_dbg(&priv->i2c_client->dev, "%s: 0x%x is set on the stereo primary\n", __func__, id);
+        return -EBUSY;
+    }
+
+    if(!priv->streaming || !priv->target_frame)
+        return daxc02_apply_ctrls(priv, &ctrl, 1);
+
+    daxc02_frame_seq_sync(priv);
+
+    spin_lock_irqsave(&priv->queue_lock, flags);
+
+    /* a target already reached has been used */
+    distance = (int32_t)(priv->target_frame - priv->frame_seq);
+    if(distance <= 0)
+    {
+        priv->target_frame = 0;
+        spin_unlock_irqrestore(&priv->queue_lock, flags);
+        return daxc02_apply_ctrls(priv, &ctrl, 1);
+    }
+
+    if(distance <= latency)
+    {
+        if(distance < latency) priv->stats.late_ctrls++;
+        spin_unlock_irqrestore(&priv->queue_lock, flags);
+        return daxc02_apply_ctrls(priv, &ctrl, 1);
+    }
+
+    if(priv->queue_len == DAXC02_QUEUE_SIZE)
+    {
+        spin_unlock_irqrestore(&priv->queue_lock, flags);
+        dev_err(&priv->i2c_client->dev, "%s: control queue full\n", __func__);
+        return -EBUSY;
+    }
+
+    entry = &priv->queue[priv->queue_len++];
+    entry->frame = priv->target_frame;
+    entry->id = id;
+    entry->value = value;
+
+    spin_unlock_irqrestore(&priv->queue_lock, flags);
+
+    daxc02_apply_schedule(priv);
+    return 0;
+}
+
+/** daxc02_apply_schedule - queues the next check of the control queue.
+ * @priv: pointer to the daxc02 struct.
+ *
+ * Polls a few times per frame so due controls are written early in the
+ * frame before their target.
+ */
+static void daxc02_apply_schedule(struct daxc02 *priv)
+{
+    unsigned int interval_us = max_t(unsigned int,
+        daxc02_frame_period_us(priv) / 4,
+        DAXC02_QUEUE_MIN_US);
+
+    schedule_delayed_work(&priv->apply, usecs_to_jiffies(interval_us));
+}
+
+/** daxc02_apply_queue - writes queued controls that are due on the next frame.
+ * @work: pointer to the apply work struct.
+ */
+static void daxc02_apply_queue(struct work_struct *work)
+{
+    struct daxc02 *priv = container_of(to_delayed_work(work), struct daxc02, apply);
+    struct i2c_client *client = priv->i2c_client;
+    struct daxc02_queued_ctrl due[DAXC02_QUEUE_SIZE];
+    unsigned int num_due = 0;
+    unsigned int pending = 0;
+    unsigned long flags;
+    int32_t distance;
+    int32_t latency;
+    unsigned int i;
+    int ret = 0;
+
+    /* serialize with daxc02_s_ctrl */
+    mutex_lock(priv->ctrl_handler.lock);
+
+    if(!priv->streaming) goto unlock;
+
+    daxc02_frame_seq_sync(priv);
+
+    spin_lock_irqsave(&priv->queue_lock, flags);
+    for(i = 0; i < priv->queue_len; i++)
+    {
+        distance = (int32_t)(priv->queue[i].frame - priv->frame_seq);
+        latency = daxc02_ctrl_latency(priv->queue[i].id);
+
+        if(distance <= latency)
+        {
+            if(distance < latency) priv->stats.late_ctrls++;
+            due[num_due++] = priv->queue[i];
+        }
+        else priv->queue[pending++] = priv->queue[i];
+    }
+    priv->queue_len = pending;
+
+    /* the target is used up once nothing is left waiting for it */
+    if(priv->target_frame && (int32_t)(priv->target_frame - priv->frame_seq) <= 0) priv->target_frame = 0;
+    spin_unlock_irqrestore(&priv->queue_lock, flags);
+
+    if(num_due)
+    {
+        ret = daxc02_apply_ctrls(priv, due, num_due);
+
+        if(ret) dev_err(&client->dev, "%s: failed to apply controls %d\n", __func__, ret);
+        else dev_dbg(&client->dev, "%s: applied %u controls for frame %u\n", __func__, num_due, due[0].frame);
+    }
+
+    if(pending) daxc02_apply_schedule(priv);
+
+    unlock:
+        mutex_unlock(priv->ctrl_handler.lock);
+}
+
+/** daxc02_stereo_bind - binds the stereo secondary named in the device tree.
+ * @priv: pointer to the daxc02 struct.
+ *
+ * The secondary may probe after the primary, so binding is retried each time
+ * the primary starts streaming.  Lock order is primary then secondary
+ * ctrl_handler lock.
+ */
+static void daxc02_stereo_bind(struct daxc02 *priv)
+{
+    struct i2c_client *client = priv->i2c_client;
+    struct i2c_client *peer_client;
+    struct camera_common_data *peer_data;
+    struct daxc02 *peer;
+
+    if(!priv->stereo_node || priv->stereo_secondary) return;
+
+    peer_client = of_find_i2c_device_by_node(priv->stereo_node);
+    if(!peer_client)
+    {
+        dev_dbg(&client->dev, "%s: stereo secondary not found\n", __func__);
+        return;
+    }
+
+    /* the subdev is the client data once the peer has probed this far */
+    if(peer_client->dev.driver != &daxc02_i2c_driver.driver || !i2c_get_clientdata(peer_client))
+    {
+        dev_dbg(&client->dev, "%s: stereo secondary not probed yet\n", __func__);
+        put_device(&peer_client->dev);
+        return;
+    }
+
+    peer_data = to_camera_common_data(&peer_client->dev);
+    peer = (struct daxc02 *)peer_data->priv;
+    if(!peer->subdev->ctrl_handler)
+    {
+        dev_dbg(&client->dev, "%s: stereo secondary controls not ready\n", __func__);
+        put_device(&peer_client->dev);
+        return;
+    }
+
+    if(peer == priv || peer->stereo_node || peer->stereo_primary)
+    {
+        dev_err(&client->dev, "%s: %s cannot be a stereo secondary\n", __func__, dev_name(&peer_client->dev));
+        put_device(&peer_client->dev);
+        return;
+    }
+
+    mutex_lock(priv->ctrl_handler.lock);
+    mutex_lock_nested(peer->ctrl_handler.lock, SINGLE_DEPTH_NESTING);
+    priv->stereo_secondary = peer;
+    peer->stereo_primary = priv;
+    mutex_unlock(peer->ctrl_handler.lock);
+    mutex_unlock(priv->ctrl_handler.lock);
+
+    dev_info(&client->dev, "stereo secondary %s bound\n", dev_name(&peer_client->dev));
+}
+
+/** daxc02_stereo_unbind - breaks the stereo binding from either side.
+ * @priv: pointer to the daxc02 struct.
+ */
+static void daxc02_stereo_unbind(struct daxc02 *priv)
+{
+    struct daxc02 *primary = priv->stereo_primary ? priv->stereo_primary : priv;
+    struct daxc02 *secondary = primary->stereo_secondary;
+
+    if(!secondary) return;
+
+    mutex_lock(primary->ctrl_handler.lock);
+    mutex_lock_nested(secondary->ctrl_handler.lock, SINGLE_DEPTH_NESTING);
+    primary->stereo_secondary = NULL;
+    secondary->stereo_primary = NULL;
+    mutex_unlock(secondary->ctrl_handler.lock);
+    mutex_unlock(primary->ctrl_handler.lock);
+
+    put_device(&secondary->i2c_client->dev);
+}
+
+/** daxc02_ctrl_get - looks up a control without taking the handler lock.
+ * @priv: pointer to the daxc02 struct.
+ * @id:   control id.
+ *
+ * For callers that already hold the ctrl_handler lock, where v4l2_ctrl_find
+ * would deadlock.
+ */
+static struct v4l2_ctrl *daxc02_ctrl_get(struct daxc02 *priv, uint32_t id)
+{
+    unsigned int i;
+
+    for(i = 0; i < priv->s_data->numctrls; i++)
+    {
+        if(priv->ctrls[i] && priv->ctrls[i]->id == id) return priv->ctrls[i];
+    }
+
+    return NULL;
+}
+
+/** daxc02_ctrl_config_get - finds this instance's configuration of a control.
+ * @priv: pointer to the daxc02 struct.
+ * @id:   control id.
+ */
+static struct v4l2_ctrl_config *daxc02_ctrl_config_get(struct daxc02 *priv, uint32_t id)
+{
+    unsigned int i;
+
+    for(i = 0; i < ARRAY_SIZE(ctrl_config_list); i++)
+    {
+        if(priv->ctrl_config[i].id == id) return &priv->ctrl_config[i];
+    }
+
+    return NULL;
+}
+
+/** daxc02_stereo_cache - records a mirrored value in a bound secondary's control.
+ * @priv:  pointer to the secondary's daxc02 struct.
+ * @id:    control id.
+ * @value: value written to the sensor, in Q42.22 format.
+ *
+ * Reading the control back on the secondary then reports what its sensor
+ * runs at.  Called with the secondary's ctrl_handler lock held.
+ */
+static void daxc02_stereo_cache(struct daxc02 *priv, uint32_t id, int64_t value)
+{
+    struct v4l2_ctrl *ctrl = daxc02_ctrl_get(priv, id);
+
+    if(!ctrl) return;
+
+    priv->stereo_sync = true;
+    __v4l2_ctrl_s_ctrl_int64(ctrl, value);
+    priv->stereo_sync = false;
+}
+
+/** daxc02_stereo_lockstep - checks that both sensors of a stereo pair match.
+ * @priv: pointer to either daxc02 struct of the pair.
+ *
+ * Compares the mode, integration time, frame length and gain last written to
+ * each sensor.  The peer is read without its lock, so a pair caught mid
+ * update reads as out of step.
+ */
+static bool daxc02_stereo_lockstep(struct daxc02 *priv)
+{
+    struct daxc02 *primary = priv->stereo_primary ? priv->stereo_primary : priv;
+    struct daxc02 *secondary = primary->stereo_secondary;
+
+    if(!secondary || !primary->streaming || !secondary->streaming) return false;
+
+    return primary->s_data->mode == secondary->s_data->mode &&
+        primary->coarse_time == secondary->coarse_time &&
+        primary->frame_length == secondary->frame_length &&
+        primary->gain == secondary->gain;
+}
+
+/** mt9m021_s_stream - starts or disables streaming.
+ * @sd:     pointer to the v4l2 sub-device.
+ * @enable: enable or disable stream.
+ */
+static int mt9m021_s_stream(struct v4l2_subdev *sd, int enable)
+{
+    struct i2c_client *client = v4l2_get_subdevdata(sd);
+    struct camera_common_data *s_data = to_camera_common_data(&client->dev);
+    struct daxc02 *priv = (struct daxc02 *)s_data->priv;
+    struct daxc02_event_data data = { 0 };
+    ktime_t start = ktime_get();
+    unsigned long flags;
+    bool bridge_faulted;
+    int ret;
+
+    dev_dbg(&client->dev, "%s\n", __func__);
+
+    if(!enable)
+    {
+        dev_info(&client->dev, "Ending stream\n");
+
+        mutex_lock(&priv->lock);
+        priv->streaming = false;
+        v4l2_ctrl_grab(v4l2_ctrl_find(&priv->ctrl_handler, DAXC02_CID_SNAPSHOT_MODE), false);
+        v4l2_ctrl_grab(v4l2_ctrl_find(&priv->ctrl_handler, DAXC02_CID_LOW_LATENCY), false);
+        mutex_unlock(&priv->lock);
+
+        cancel_delayed_work_sync(&priv->monitor);
+        cancel_delayed_work_sync(&priv->apply);
+        cancel_delayed_work_sync(&priv->thermal);
+        daxc02_strobe_arm(priv, false);
+        priv->temp_valid = false;
+        priv->hold_count = 0;
+
+        /* queued controls and their target belong to this stream */
+        spin_lock_irqsave(&priv->queue_lock, flags);
+        priv->queue_len = 0;
+        priv->target_frame = 0;
+        spin_unlock_irqrestore(&priv->queue_lock, flags);
+
+        /* the cap belongs to this stream, the next mode may run cooler or at another rate */
+        if(priv->thermal_level)
+        {
+            priv->thermal_level = 0;
+            priv->frame_rate_cap = 0;
+            data.frame = priv->frame_seq;
+            daxc02_queue_event(client, DAXC02_EVENT_THERMAL, &data);
+        }
+
+        return mt9m021_write(client, MT9M021_RESET_REG, MT9M021_STREAM_OFF);
+    }
+    else dev_info(&client->dev, "Starting stream in mode %d\n", priv->s_data->mode);
+
+    mutex_lock(&priv->lock);
+
+    /* the sensor comes up with no group hold */
+    priv->hold_count = 0;
+
+    daxc02_stereo_bind(priv);
+
+    /* the exposure limit follows the line length */
+    daxc02_update_mode(priv);
+
+    ret = daxc02_start_stream(priv);
+    if(!ret)
+    {
+        priv->streaming = true;
+        priv->stall_level = DAXC02_RECOVER_NONE;
+        priv->reinit_count = 0;
+        priv->watchdog_seq = priv->frame_seq;
+
+        /* errors latched while the bridge came up are not stalls */
+        daxc02_bridge_faults(client, &bridge_faulted);
+
+        v4l2_ctrl_grab(v4l2_ctrl_find(&priv->ctrl_handler, DAXC02_CID_SNAPSHOT_MODE), true);
+        v4l2_ctrl_grab(v4l2_ctrl_find(&priv->ctrl_handler, DAXC02_CID_LOW_LATENCY), true);
+
+        /* an armed sensor is idle between triggers */
+        if(watchdog && !priv->snapshot) daxc02_monitor_schedule(priv);
+        if(thermal_interval_ms) daxc02_thermal_schedule(priv);
+
+        data.frame = priv->frame_seq;
+        data.value = ktime_us_delta(ktime_get(), start);
+        daxc02_queue_event(client, DAXC02_EVENT_STREAM_STARTED, &data);
+        dev_dbg(&client->dev, "%s: stream on took %lld us\n", __func__, data.value);
+    }
+
+    mutex_unlock(&priv->lock);
+    return ret;
+}
+
+/** daxc02_g_input_status - get input status.
+ * @sd:     pointer to the v4l2 sub-device.
+ * @status: where to store the status.
+ */
+static int daxc02_g_input_status(struct v4l2_subdev *sd, uint32_t *status)
+{
+    struct i2c_client *client = v4l2_get_subdevdata(sd);
+    struct camera_common_data *s_data = to_camera_common_data(&client->dev);
+    struct daxc02 *priv = (struct daxc02 *)s_data->priv;
+    struct camera_common_power_rail *pw = &priv->power;
+
+    dev_dbg(&client->dev, "%s\n", __func__);
+
+    *status = pw->state == SWITCH_ON;
+    return 0;
+}
+
+/*
+ * Registers the v4l2 sub device video operations.
+ */
+static struct v4l2_subdev_video_ops daxc02_subdev_video_ops = {
+    .s_stream               = mt9m021_s_stream,
+    .g_mbus_config          = camera_common_g_mbus_config,
+    .g_input_status         = daxc02_g_input_status,
+};
+
+
+/***************************************************
+        V4L2 Subdev Core Operations
+****************************************************/
+
+/** daxc02_queue_event - sends a private event to the sub-device node.
+ * @client: pointer to the i2c client.
+ * @type:   DAXC02_EVENT_* type.
+ * @data:   event payload.
+ *
+ * Safe from any context, does nothing until the sub-device node exists.
+ */
+static void daxc02_queue_event(struct i2c_client *client, uint32_t type, const struct daxc02_event_data *data)
+{
+    struct v4l2_subdev *sd = i2c_get_clientdata(client);
+    struct v4l2_event event;
+
+    if(!sd || !sd->devnode) return;
+
+    memset(&event, 0, sizeof(event));
+    event.type = type;
+    memcpy(event.u.data, data, sizeof(*data));
+
+    v4l2_event_queue(sd->devnode, &event);
+}
+
+/** daxc02_error_event - reports a failed sensor or bridge transfer.
+ * @client: pointer to the i2c client.
+ * @source: DAXC02_EVENT_SRC_* device that failed.
+ * @addr:   register address.
+ * @error:  error code.
+ */
+static void daxc02_error_event(struct i2c_client *client, uint32_t source, uint16_t addr, int error)
+{
+    struct daxc02_event_data data = {
+        .id     = addr,
+        .value  = error,
+        .source = source,
+    };
+
+    daxc02_queue_event(client, DAXC02_EVENT_ERROR, &data);
+}
+
+/** daxc02_subscribe_event - subscribes a file handle to control or driver events.
+ * @sd:     pointer to the v4l2 sub-device.
+ * @fh:     pointer to the v4l2 file handle.
+ * @sub:    event subscription.
+ */
+static int daxc02_subscribe_event(struct v4l2_subdev *sd, struct v4l2_fh *fh, struct v4l2_event_subscription *sub)
+{
+    switch(sub->type)
+    {
+        case V4L2_EVENT_CTRL:
+            return v4l2_ctrl_subdev_subscribe_event(sd, fh, sub);
+        case DAXC02_EVENT_STREAM_STARTED:
+        case DAXC02_EVENT_CTRL_APPLIED:
+        case DAXC02_EVENT_ERROR:
+        case DAXC02_EVENT_RECOVERY:
+        case DAXC02_EVENT_THERMAL:
+        case DAXC02_EVENT_EXPOSURE:
+            return v4l2_event_subscribe(fh, sub, DAXC02_EVENT_QUEUE_LEN, NULL);
+    }
+
+    return -EINVAL;
+}
+
+static struct v4l2_subdev_core_ops daxc02_subdev_core_ops = {
+    .s_power                = camera_common_s_power,
+    .subscribe_event        = daxc02_subscribe_event,
+    .unsubscribe_event      = v4l2_event_subdev_unsubscribe,
+};
+
+
+/***************************************************
+        V4L2 Subdev Pad Operations
+****************************************************/
+
+static int mt9m021_get_format(struct v4l2_subdev *sd, struct v4l2_subdev_pad_config *cfg, struct v4l2_subdev_format *format)
+{
+    return camera_common_g_fmt(sd, &format->format);
+}
+
+static int mt9m021_set_format(struct v4l2_subdev *sd, struct v4l2_subdev_pad_config *cfg, struct v4l2_subdev_format *format)
+{
+    struct i2c_client *client = v4l2_get_subdevdata(sd);
+    struct camera_common_data *s_data = to_camera_common_data(&client->dev);
+    struct daxc02 *priv = (struct daxc02 *)s_data->priv;
+    struct v4l2_ctrl *ctrl;
+    int ret;
+
+    if (format->which == V4L2_SUBDEV_FORMAT_TRY)
+        return camera_common_try_fmt(sd, &format->format);
+
+    ret = camera_common_s_fmt(sd, &format->format);
+    if(ret) return ret;
+
+    /* camera_common matched the size, the Frame Rate control picks among modes of that size */
+    ctrl = v4l2_ctrl_find(&priv->ctrl_handler, TEGRA_CAMERA_CID_FRAME_RATE);
+    if(ctrl) daxc02_select_mode(priv, v4l2_ctrl_g_ctrl_int64(ctrl));
+
+    daxc02_update_mode(priv);
+    return 0;
+}
+
+/** daxc02_size_max_fps - gets the fastest frame rate of any mode at the current size.
+ * @s_data: pointer to the camera common data.
+ */
+static int daxc02_size_max_fps(struct camera_common_data *s_data)
+{
+    const struct camera_common_frmfmt *cur = &s_data->frmfmt[s_data->mode];
+    int fps = cur->framerates[0];
+    int i;
+
+    for(i = 0; i < s_data->numfmts; i++)
+    {
+        if(s_data->frmfmt[i].size.width == cur->size.width &&
+           s_data->frmfmt[i].size.height == cur->size.height)
+            fps = max(fps, s_data->frmfmt[i].framerates[0]);
+    }
+
+    return fps;
+}
+
+/** daxc02_select_mode - picks the mode for a frame rate among modes of the current size.
+ * @priv:       pointer to the daxc02 struct.
+ * @frame_rate: requested frame rate in Q42.22 format.
+ *
+ * camera_common matches modes by size only, so modes that differ only in
+ * frame rate are chosen here, on set_fmt and on Frame Rate writes before
+ * stream on.  The slowest mode that still reaches the rate wins, the fastest
+ * when none does.  Returns true when the mode changed.
+ */
+static bool daxc02_select_mode(struct daxc02 *priv, int64_t frame_rate)
+{
+    struct camera_common_data *s_data = priv->s_data;
+    const struct camera_common_frmfmt *cur = &s_data->frmfmt[s_data->mode];
+    int best = -1;
+    int fastest = s_data->mode;
+    int i;
+
+    for(i = 0; i < s_data->numfmts; i++)
+    {
+        const struct camera_common_frmfmt *fmt = &s_data->frmfmt[i];
+        int64_t mode_rate = (int64_t)fmt->framerates[0] * FIXED_POINT_SCALING_FACTOR;
+
+        if(fmt->size.width != cur->size.width || fmt->size.height != cur->size.height) continue;
+
+        if(fmt->framerates[0] > s_data->frmfmt[fastest].framerates[0]) fastest = i;
+        if(mode_rate >= frame_rate && (best < 0 || fmt->framerates[0] < s_data->frmfmt[best].framerates[0]))
+            best = i;
+    }
+
+    if(best < 0) best = fastest;
+    if(s_data->frmfmt[best].mode == s_data->mode) return false;
+
+    dev_dbg(&priv->i2c_client->dev, "%s: mode %d for %d fps\n", __func__,
+        s_data->frmfmt[best].mode, s_data->frmfmt[best].framerates[0]);
+
+    s_data->mode = s_data->frmfmt[best].mode;
+    return true;
+}
+
+/** daxc02_mode_timing - points the line length and timing model at the current mode.
+ * @priv:           pointer to the daxc02 struct.
+ * @min_frame_rate: slowest frame rate in Q42.22 format.
+ */
+static void daxc02_mode_timing(struct daxc02 *priv, int64_t min_frame_rate)
+{
+    struct camera_common_data *s_data = priv->s_data;
+    int64_t max_frame_rate = (int64_t)s_data->frmfmt[s_data->mode].framerates[0] * FIXED_POINT_SCALING_FACTOR;
+
+    /* camera_common and VI read the line time from the mode, keep it on the active readout */
+    s_data->sensor_props.sensor_modes[s_data->mode].image_properties.line_length = mt9m021_line_length(priv);
+
+    /* the timing tops out at the mode rate, VFR may stretch it to the minimum */
+    daxc02_timing_update(priv, min_frame_rate, max_frame_rate);
+}
+
+/** daxc02_update_mode - Refreshes mode dependent controls after a format change.
+ * @priv: pointer to the daxc02 struct.
+ */
+static void daxc02_update_mode(struct daxc02 *priv)
+{
+    struct camera_common_data *s_data = priv->s_data;
+    struct v4l2_ctrl_config *config;
+    struct v4l2_ctrl *ctrl;
+    int64_t max_frame_rate;
+    int64_t max_exposure;
+
+    ctrl = v4l2_ctrl_find(&priv->ctrl_handler, DAXC02_CID_ISP_PROFILE);
+    if(ctrl) v4l2_ctrl_s_ctrl_string(ctrl, priv->isp_profile[s_data->mode]);
+
+    /* the control reaches every mode at this size, see daxc02_select_mode */
+    ctrl = v4l2_ctrl_find(&priv->ctrl_handler, TEGRA_CAMERA_CID_FRAME_RATE);
+    if(!ctrl) return;
+
+    /* the ranges never grow past the ones the device tree narrowed them to */
+    config = daxc02_ctrl_config_get(priv, TEGRA_CAMERA_CID_FRAME_RATE);
+    max_frame_rate = min_t(int64_t, (int64_t)daxc02_size_max_fps(s_data) * FIXED_POINT_SCALING_FACTOR, config->max);
+    max_frame_rate = max_t(int64_t, max_frame_rate, ctrl->minimum);
+    v4l2_ctrl_modify_range(ctrl, ctrl->minimum, max_frame_rate, ctrl->step,
+        min_t(int64_t, ctrl->default_value, max_frame_rate));
+
+    daxc02_mode_timing(priv, ctrl->minimum);
+
+    priv->frame_length_req = clamp_t(uint32_t, mt9m021_frame_length(priv, v4l2_ctrl_g_ctrl_int64(ctrl)),
+        priv->timing.min_frame_length, priv->timing.max_frame_length);
+
+    config = daxc02_ctrl_config_get(priv, TEGRA_CAMERA_CID_EXPOSURE);
+    max_exposure = min_t(int64_t, priv->timing.max_exposure, config->max);
+
+    ctrl = v4l2_ctrl_find(&priv->ctrl_handler, TEGRA_CAMERA_CID_EXPOSURE);
+    if(!ctrl) return;
+
+    max_exposure = max_t(int64_t, max_exposure, ctrl->minimum);
+    v4l2_ctrl_modify_range(ctrl, ctrl->minimum, max_exposure, ctrl->step,
+        min_t(int64_t, ctrl->default_value, max_exposure));
+}
+
+/*
+ * Registers the v4l2 sub-device pad operations.
+ */
+static struct v4l2_subdev_pad_ops mt9m021_subdev_pad_ops = {
+    .get_fmt                = mt9m021_get_format,
+    .set_fmt                = mt9m021_set_format,
+    .enum_mbus_code         = camera_common_enum_mbus_code,
+    .enum_frame_size        = camera_common_enum_framesizes,
+    .enum_frame_interval    = camera_common_enum_frameintervals,
+};
+
+
+/***************************************************
+        V4L2 Subdev Operations
+****************************************************/
+
+static struct v4l2_subdev_ops daxc02_subdev_ops = {
+    .core                   = &daxc02_subdev_core_ops,
+    .video                  = &daxc02_subdev_video_ops,
+    .pad                    = &mt9m021_subdev_pad_ops,
+};
+
+
+/***************************************************
+        Camera Common Operations
+****************************************************/
+
+static struct camera_common_sensor_ops daxc02_common_ops = {
+    .power_on               = daxc02_power_on,
+    .power_off              = daxc02_power_off,
+};
+
+
+/***********************************************************
+    V4L2 subdev internal operations
+************************************************************/
+
+/** daxc02_open - Called by the v4l2 framework when the device is opened.
+ * @sd:     pointer to the v4l2 sub-device.
+ * @fh:     pointer to the v4l2 sub-device file handle.
+ */
+static int daxc02_open(struct v4l2_subdev *sd, struct v4l2_subdev_fh *fh)
+{
+    struct i2c_client *client = v4l2_get_subdevdata(sd);
+    dev_dbg(&client->dev, "%s\n", __func__);
+    return 0;
+}
+
+/*
+ * Registers the v4l2 sub-device internal operations.
+ */
+static const struct v4l2_subdev_internal_ops mt9m021_subdev_internal_ops = {
+    .open               = daxc02_open,
+};
+
+
+/***************************************************
+        Media Entity Operations
+****************************************************/
+
+static const struct media_entity_operations daxc02_media_ops = {
+    .link_validate      = v4l2_subdev_link_validate,
+};
+
+
+/***************************************************
+        Sysfs Attributes
+****************************************************/
+
+#define DAXC02_STAT_ATTR(_name)                                                 \
+static ssize_t _name##_show(struct device *dev,                                 \
+                            struct device_attribute *attr, char *buf)           \
+{                                                                               \
+    struct camera_common_data *s_data = to_camera_common_data(dev);             \
+    struct daxc02 *priv = (struct daxc02 *)s_data->priv;                        \
+    return sprintf(buf, "%u\n", priv->stats._name);                             \
+}                                                                               \
+static DEVICE_ATTR_RO(_name)
+
+DAXC02_STAT_ATTR(stalls);
+DAXC02_STAT_ATTR(bridge_faults);
+DAXC02_STAT_ATTR(bridge_restarts);
+DAXC02_STAT_ATTR(stream_restarts);
+DAXC02_STAT_ATTR(reinits);
+DAXC02_STAT_ATTR(recovered);
+DAXC02_STAT_ATTR(late_ctrls);
+DAXC02_STAT_ATTR(snapshots);
+DAXC02_STAT_ATTR(thermal_throttles);
+DAXC02_STAT_ATTR(strobe_misses);
+
+static struct attribute *daxc02_stats_attrs[] = {
+    &dev_attr_stalls.attr,
+    &dev_attr_bridge_faults.attr,
+    &dev_attr_bridge_restarts.attr,
+    &dev_attr_stream_restarts.attr,
+    &dev_attr_reinits.attr,
+    &dev_attr_recovered.attr,
+    &dev_attr_late_ctrls.attr,
+    &dev_attr_snapshots.attr,
+    &dev_attr_thermal_throttles.attr,
+    &dev_attr_strobe_misses.attr,
+    NULL,
+};
+
+/*
+ * Watchdog counters, found under /sys/bus/i2c/devices/<dev>/stats/.
+ */
+static const struct attribute_group daxc02_stats_group = {
+    .name               = "stats",
+    .attrs              = daxc02_stats_attrs,
+};
+
+
+/***************************************************
+        Firmware Tables
+****************************************************/
+
+/** daxc02_fw_alloc - Allocates the batches and messages of an encoded table.
+ * @dev:            device owning the allocations.
+ * @table:          table to allocate.
+ * @num_batches:    number of batches.
+ * @num_msgs:       number of messages across all batches.
+ * @msg_len:        bytes per message.
+ */
+static int daxc02_fw_alloc(struct device *dev, struct daxc02_fw_table *table, unsigned int num_batches, unsigned int num_msgs, size_t msg_len)
+{
+    struct i2c_msg *msgs;
+    uint8_t *buf;
+    unsigned int i;
+
+    table->batches = devm_kcalloc(dev, num_batches, sizeof(*table->batches), GFP_KERNEL);
+    msgs = devm_kcalloc(dev, max(num_msgs, 1U), sizeof(*msgs), GFP_KERNEL);
+    buf = devm_kcalloc(dev, max(num_msgs, 1U), msg_len, GFP_KERNEL);
+    if(!table->batches || !msgs || !buf) return -ENOMEM;
+
+    for(i = 0; i < num_msgs; i++)
+    {
+        msgs[i].flags = 0;
+        msgs[i].len = msg_len;
+        msgs[i].buf = buf + i * msg_len;
+    }
+
+    table->num_batches = num_batches;
+    table->batches[0].msgs = msgs;
+    return 0;
+}
+
+/** daxc02_fw_encode_regs - Encodes a sensor register table.
+ * @priv:   pointer to the daxc02 struct.
+ * @regs:   table entries from the blob.
+ * @count:  number of entries.
+ * @table:  where to store the encoded table.
+ */
+static int daxc02_fw_encode_regs(struct daxc02 *priv, const struct daxc02_fw_reg *regs, uint32_t count, struct daxc02_fw_table *table)
+{
+    struct daxc02_fw_batch *batch;
+    unsigned int num_batches = 1;
+    unsigned int num_msgs = 0;
+    uint16_t addr, val;
+    uint8_t *buf;
+    uint32_t i;
+    int ret;
+
+    for(i = 0; i < count; i++)
+    {
+        if(le16_to_cpu(regs[i].addr) == MT9M021_TABLE_WAIT_MS) num_batches++;
+        else num_msgs++;
+    }
+
+    ret = daxc02_fw_alloc(&priv->i2c_client->dev, table, num_batches, num_msgs, 4);
+    if(ret) return ret;
+
+    batch = table->batches;
+    for(i = 0; i < count; i++)
+    {
+        addr = le16_to_cpu(regs[i].addr);
+        val = le16_to_cpu(regs[i].val);
+
+        if(addr == MT9M021_TABLE_WAIT_MS)
+        {
+            batch->wait_ms = val;
+            batch[1].msgs = batch->msgs + batch->num_msgs;
+            batch++;
+            continue;
+        }
+
+        batch->msgs[batch->num_msgs].addr = priv->i2c_client->addr;
+        buf = batch->msgs[batch->num_msgs++].buf;
+        buf[0] = addr >> 8;
+        buf[1] = addr & 0xff;
+        buf[2] = val >> 8;
+        buf[3] = val & 0xff;
+    }
+
+    return 0;
+}
+
+/** daxc02_fw_encode_bridge - Encodes a MIPI bridge register table.
+ * @priv:       pointer to the daxc02 struct.
+ * @regs:       table entries from the blob.
+ * @count:      number of entries.
+ * @low_clock:  apply daxc02_buffer_low_clock over the entries.
+ * @table:      where to store the encoded table.
+ *
+ * Uses the same byte order as daxc02_bridge_write.
+ */
+static int daxc02_fw_encode_bridge(struct daxc02 *priv, const struct daxc02_fw_bridge *regs, uint32_t count, bool low_clock, struct daxc02_fw_table *table)
+{
+    struct i2c_msg *msg;
+    uint16_t addr;
+    uint32_t data;
+    uint32_t i;
+    int ret;
+
+    ret = daxc02_fw_alloc(&priv->i2c_client->dev, table, 1, count, 6);
+    if(ret) return ret;
+
+    for(i = 0; i < count; i++)
+    {
+        addr = le16_to_cpu(regs[i].addr);
+        data = daxc02_bridge_data(addr, le32_to_cpu(regs[i].data), low_clock);
+
+        msg = &table->batches[0].msgs[i];
+        msg->addr = BRIDGE_I2C_ADDR;
+        msg->len = le16_to_cpu(regs[i].len) + 2;
+        msg->buf[0] = (uint8_t)(addr >> 8);
+        msg->buf[1] = (uint8_t)(addr >> 0);
+        msg->buf[2] = (uint8_t)(data >> 8);
+        msg->buf[3] = (uint8_t)(data >> 0);
+        msg->buf[4] = (uint8_t)(data >> 24);
+        msg->buf[5] = (uint8_t)(data >> 16);
+    }
+
+    table->batches[0].num_msgs = count;
+    return 0;
+}
+
+/** daxc02_fw_parse - Validates a blob and encodes its tables.
+ * @priv:   pointer to the daxc02 struct.
+ * @blob:   firmware loaded by request_firmware.
+ */
+static int daxc02_fw_parse(struct daxc02 *priv, const struct firmware *blob)
+{
+    struct device *dev = &priv->i2c_client->dev;
+    const struct daxc02_fw_header *header = (const struct daxc02_fw_header *)blob->data;
+    const struct daxc02_fw_section *section;
+    const struct daxc02_fw_frmfmt *frmfmt = NULL;
+    const uint8_t *data = blob->data + sizeof(*header);
+    const uint8_t *end = blob->data + blob->size;
+    unsigned long found = 0;
+    struct daxc02_fw *fw;
+    size_t entry_size;
+    unsigned int bit;
+    uint16_t type, index;
+    uint32_t count, i;
+    int ret;
+
+    if(blob->size < sizeof(*header) || le32_to_cpu(header->magic) != DAXC02_FW_MAGIC)
+    {
+        dev_err(dev, "firmware: bad magic\n");
+        return -EINVAL;
+    }
+
+    if(le16_to_cpu(header->version) != DAXC02_FW_VERSION)
+    {
+        dev_err(dev, "firmware: unsupported version %u\n", le16_to_cpu(header->version));
+        return -EINVAL;
+    }
+
+    if(le32_to_cpu(header->size) != blob->size ||
+       (crc32_le(~0, data, end - data) ^ ~0) != le32_to_cpu(header->crc32))
+    {
+        dev_err(dev, "firmware: size or crc mismatch\n");
+        return -EINVAL;
+    }
+
+    fw = devm_kzalloc(dev, sizeof(*fw), GFP_KERNEL);
+    if(!fw) return -ENOMEM;
+
+    /* the DT sensor modes describe the same modes */
+    fw->num_modes = le16_to_cpu(header->num_modes);
+    fw->revision = le32_to_cpu(header->revision);
+    if(!fw->num_modes || fw->num_modes > DAXC02_FW_MAX_MODES ||
+        fw->num_modes != priv->s_data->sensor_props.num_modes)
+    {
+        dev_err(dev, "firmware: %u modes, device tree has %u\n",
+            fw->num_modes, priv->s_data->sensor_props.num_modes);
+        return -EINVAL;
+    }
+
+    fw->modes = devm_kcalloc(dev, fw->num_modes, sizeof(*fw->modes), GFP_KERNEL);
+    if(!fw->modes) return -ENOMEM;
+
+    while(data < end)
+    {
+        if(end - data < sizeof(*section)) goto truncated;
+
+        section = (const struct daxc02_fw_section *)data;
+        type = le16_to_cpu(section->type);
+        index = le16_to_cpu(section->index);
+        count = le32_to_cpu(section->count);
+        data += sizeof(*section);
+
+        switch(type)
+        {
+            case DAXC02_FW_SECTION_COMMON:
+            case DAXC02_FW_SECTION_MODE:
+                entry_size = sizeof(struct daxc02_fw_reg);
+                break;
+            case DAXC02_FW_SECTION_BRIDGE:
+                entry_size = sizeof(struct daxc02_fw_bridge);
+                break;
+            case DAXC02_FW_SECTION_FRMFMT:
+                entry_size = sizeof(struct daxc02_fw_frmfmt);
+                break;
+            default:
+                dev_err(dev, "firmware: unknown section %u\n", type);
+                return -EINVAL;
+        }
+
+        if(count > DAXC02_FW_MAX_ENTRIES || end - data < count * entry_size) goto truncated;
+
+        /* one bit per section, modes after the fixed sections */
+        bit = type;
+        if(type == DAXC02_FW_SECTION_MODE)
+        {
+            if(index >= fw->num_modes)
+            {
+                dev_err(dev, "firmware: mode %u out of range\n", index);
+                return -EINVAL;
+            }
+            bit = DAXC02_FW_SECTION_FRMFMT + 1 + index;
+        }
+
+        if(found & BIT(bit))
+        {
+            dev_err(dev, "firmware: duplicate section %u\n", type);
+            return -EINVAL;
+        }
+        found |= BIT(bit);
+
+        switch(type)
+        {
+            case DAXC02_FW_SECTION_COMMON:
+            case DAXC02_FW_SECTION_MODE:
+                for(i = 0; i < count; i++)
+                {
+                    if(le16_to_cpu(((const struct daxc02_fw_reg *)data)[i].addr) == MT9M021_TABLE_END)
+                    {
+                        dev_err(dev, "firmware: bad register in section %u\n", type);
+                        return -EINVAL;
+                    }
+                }
+
+                ret = daxc02_fw_encode_regs(priv, (const struct daxc02_fw_reg *)data, count,
+                    type == DAXC02_FW_SECTION_COMMON ? &fw->common : &fw->modes[index]);
+                if(ret) return ret;
+                break;
+
+            case DAXC02_FW_SECTION_BRIDGE:
+                for(i = 0; i < count; i++)
+                {
+                    uint16_t len = le16_to_cpu(((const struct daxc02_fw_bridge *)data)[i].len);
+                    if(len != 2 && len != 4)
+                    {
+                        dev_err(dev, "firmware: bad bridge register width %u\n", len);
+                        return -EINVAL;
+                    }
+                }
+
+                ret = daxc02_fw_encode_bridge(priv, (const struct daxc02_fw_bridge *)data, count, false, &fw->bridge);
+                if(!ret) ret = daxc02_fw_encode_bridge(priv, (const struct daxc02_fw_bridge *)data, count, true, &fw->bridge_low_clock);
+                if(ret) return ret;
+                break;
+
+            case DAXC02_FW_SECTION_FRMFMT:
+                if(count != fw->num_modes)
+                {
+                    dev_err(dev, "firmware: %u frame formats for %u modes\n", count, fw->num_modes);
+                    return -EINVAL;
+                }
+                frmfmt = (const struct daxc02_fw_frmfmt *)data;
+                break;
+        }
+
+        data += count * entry_size;
+    }
+
+    if(found != BIT(DAXC02_FW_SECTION_FRMFMT + 1 + fw->num_modes) - 1)
+    {
+        dev_err(dev, "firmware: missing sections 0x%lx\n", ~found & (BIT(DAXC02_FW_SECTION_FRMFMT + 1 + fw->num_modes) - 1));
+        return -EINVAL;
+    }
+
+    fw->frmfmt = devm_kcalloc(dev, fw->num_modes, sizeof(*fw->frmfmt), GFP_KERNEL);
+    fw->framerates = devm_kcalloc(dev, fw->num_modes, sizeof(*fw->framerates), GFP_KERNEL);
+    fw->isp_profile = devm_kcalloc(dev, fw->num_modes, sizeof(*fw->isp_profile), GFP_KERNEL);
+    if(!fw->frmfmt || !fw->framerates || !fw->isp_profile) return -ENOMEM;
+
+    for(i = 0; i < fw->num_modes; i++)
+    {
+        fw->framerates[i]               = le16_to_cpu(frmfmt[i].fps);
+        fw->frmfmt[i].size.width        = le16_to_cpu(frmfmt[i].width);
+        fw->frmfmt[i].size.height       = le16_to_cpu(frmfmt[i].height);
+        fw->frmfmt[i].framerates        = &fw->framerates[i];
+        fw->frmfmt[i].num_framerates    = 1;
+        fw->frmfmt[i].hdr_en            = 0;
+        fw->frmfmt[i].mode              = i;
+        fw->isp_profile[i] = (le16_to_cpu(frmfmt[i].flags) & DAXC02_FW_FRMFMT_HFR) ?
+            DAXC02_ISP_PROFILE_HFR : DAXC02_ISP_PROFILE_DEFAULT;
+
+        if(!fw->framerates[i] ||
+           fw->frmfmt[i].size.width < MT9M021_WINDOW_WIDTH_MIN || fw->frmfmt[i].size.width > MT9M021_WINDOW_WIDTH_MAX ||
+           fw->frmfmt[i].size.height < MT9M021_WINDOW_HEIGHT_MIN || fw->frmfmt[i].size.height > MT9M021_WINDOW_HEIGHT_MAX)
+        {
+            dev_err(dev, "firmware: bad frame format for mode %u\n", i);
+            return -EINVAL;
+        }
+    }
+
+    priv->fw = fw;
+    return 0;
+
+    truncated:
+        dev_err(dev, "firmware: truncated section\n");
+        return -EINVAL;
+}
+
+/** daxc02_fw_load - Loads the optional register table blob named in the device tree.
+ * @priv: pointer to the daxc02 struct.
+ *
+ * On success the blob's tables and frame formats replace the built in ones.
+ */
+static int daxc02_fw_load(struct daxc02 *priv)
+{
+    struct i2c_client *client = priv->i2c_client;
+    struct camera_common_data *s_data = priv->s_data;
+    const struct firmware *blob;
+    const char *name;
+    int ret;
+
+    if(of_property_read_string(client->dev.of_node, "firmware-name", &name)) return 0;
+
+    ret = request_firmware(&blob, name, &client->dev);
+    if(ret)
+    {
+        dev_err(&client->dev, "unable to load %s, using built in tables\n", name);
+        return ret;
+    }
+
+    ret = daxc02_fw_parse(priv, blob);
+    release_firmware(blob);
+
+    if(ret)
+    {
+        dev_err(&client->dev, "invalid %s, using built in tables\n", name);
+        return ret;
+    }
+
+    s_data->frmfmt = priv->fw->frmfmt;
+    s_data->numfmts = priv->fw->num_modes;
+    priv->isp_profile = priv->fw->isp_profile;
+
+    if(s_data->def_mode >= s_data->numfmts) daxc02_set_default_mode(s_data, 0);
+    else daxc02_set_default_mode(s_data, s_data->def_mode);
+
+    dev_info(&client->dev, "loaded %s revision %u, %u modes\n", name, priv->fw->revision, priv->fw->num_modes);
+    return 0;
+}
+
+/** daxc02_fw_replay - Writes an encoded register table.
+ * @client: pointer to the i2c client.
+ * @table:  encoded table.
+ */
+static int daxc02_fw_replay(struct i2c_client *client, const struct daxc02_fw_table *table)
+{
+    const struct daxc02_fw_batch *batch;
+    unsigned int i;
+    int ret;
+
+    for(i = 0; i < table->num_batches; i++)
+    {
+        batch = &table->batches[i];
+
+        if(batch->num_msgs)
+        {
+            ret = i2c_transfer(client->adapter, batch->msgs, batch->num_msgs);
+            if(ret != batch->num_msgs)
+            {
+                if(ret >= 0) ret = -EIO;
+                dev_err(&client->dev, "%s: batch %u at 0x%02x%02x failed %d\n", __func__,
+                    i, batch->msgs[0].buf[0], batch->msgs[0].buf[1], ret);
+                daxc02_error_event(client,
+                    batch->msgs[0].addr == BRIDGE_I2C_ADDR ? DAXC02_EVENT_SRC_BRIDGE : DAXC02_EVENT_SRC_SENSOR,
+                    (batch->msgs[0].buf[0] << 8) | batch->msgs[0].buf[1], ret);
+                return ret;
+            }
+        }
+
+        if(batch->wait_ms) msleep_range(batch->wait_ms);
+    }
+
+    return 0;
+}
+
+
+/***************************************************
+        Thermal Governor
+****************************************************/
+
+/** daxc02_temp_start - powers up the temperature sensor and reads its calibration.
+ * @priv: pointer to the daxc02 struct.
+ */
+static int daxc02_temp_start(struct daxc02 *priv)
+{
+    struct i2c_client *client = priv->i2c_client;
+    int ret;
 
-    ret = mt9m021_write_table(client, daxc02_mode_table_common);
-    if(ret < 0)
-    {
-        dev_err(&client->dev, "%s: failed to configure mt9m021.\n", __func__);
-        return ret;
-    }
+    ret = mt9m021_read(client, MT9M021_TEMPSENS_CALIB1, &priv->temp_calib[0]);
+    if(!ret) ret = mt9m021_read(client, MT9M021_TEMPSENS_CALIB2, &priv->temp_calib[1]);
+    if(ret) return ret;
 
-    ret = mt9m021_write_table(client, mode_table[priv->s_data->mode]);
-    if(ret < 0)
+    if(priv->temp_calib[0] <= priv->temp_calib[1])
     {
-        dev_err(&client->dev, "%s: failed to set mode.\n", __func__);
-        return ret;
+        dev_err(&client->dev, "temperature sensor calibration 0x%04x/0x%04x invalid\n",
+            priv->temp_calib[0], priv->temp_calib[1]);
+        return -EINVAL;
     }
 
-    if(s_data->override_enable)
-    {
-        memset(&ctrls, 0, sizeof(ctrls));
-        ctrls.ctrl_class = V4L2_CTRL_ID2CLASS(TEGRA_CAMERA_CID_GAIN);
-        ctrls.count = 3;
-        ctrls.controls = control;
-
-        control[0].id = TEGRA_CAMERA_CID_GAIN;
-        control[1].id = TEGRA_CAMERA_CID_FRAME_RATE;
-        control[2].id = TEGRA_CAMERA_CID_EXPOSURE;
+    return mt9m021_write(client, MT9M021_TEMPSENS_CTRL, MT9M021_TEMPSENS_POWER | MT9M021_TEMPSENS_START);
+}
 
-        ret = v4l2_g_ext_ctrls(&priv->ctrl_handler, &ctrls);
-        if(ret == 0)
-        {
-            ret |= mt9m021_set_gain(priv, control[0].value64);
-            if(ret) dev_err(&client->dev, "%s: error gain override\n", __func__);
+/** daxc02_temp_sample - reads the sensor temperature in millicelsius.
+ * @priv: pointer to the daxc02 struct.
+ *
+ * Interpolates between the 55C and 70C readings stored in the sensor, then
+ * starts the next conversion.
+ */
+static int daxc02_temp_sample(struct daxc02 *priv)
+{
+    struct i2c_client *client = priv->i2c_client;
+    uint16_t data;
+    int ret;
 
-            ret |= mt9m021_set_frame_rate(priv, control[1].value64);
-            if(ret) dev_err(&client->dev, "%s: error frame length override\n", __func__);
+    if(priv->temp_calib[0] <= priv->temp_calib[1]) return -ENODEV;
 
-            ret |= mt9m021_set_exposure(priv, control[2].value64);
-            if(ret) dev_err(&client->dev, "%s: error exposure override\n", __func__);
+    ret = mt9m021_read(client, MT9M021_TEMPSENS_DATA, &data);
+    if(ret) return ret;
 
-        }
-        else dev_err(&client->dev, "%s: failed to get overrides\n", __func__);
-    }
+    priv->temperature = MT9M021_TEMPSENS_CALIB2_MC +
+        ((int)(data & MT9M021_TEMPSENS_DATA_MASK) - priv->temp_calib[1]) *
+        (MT9M021_TEMPSENS_CALIB1_MC - MT9M021_TEMPSENS_CALIB2_MC) /
+        (priv->temp_calib[0] - priv->temp_calib[1]);
+    priv->temp_valid = true;
 
-    /* start streaming */
-    ret = mt9m021_write(client, MT9M021_RESET_REG, MT9M021_MASTER_MODE);
+    ret = mt9m021_write(client, MT9M021_TEMPSENS_CTRL, MT9M021_TEMPSENS_POWER | MT9M021_TEMPSENS_CLEAR);
+    if(!ret) ret = mt9m021_write(client, MT9M021_TEMPSENS_CTRL, MT9M021_TEMPSENS_POWER | MT9M021_TEMPSENS_START);
 
     return ret;
 }
 
-/** daxc02_g_input_status - get input status.
- * @sd:     pointer to the v4l2 sub-device.
- * @status: where to store the status.
+/** daxc02_thermal_govern - steps the frame rate cap with the sensor temperature.
+ * @priv: pointer to the daxc02 struct.
+ *
+ * Each sample at or above the throttle point halves the cap, down to the
+ * minimum frame rate.  Each sample at or below the resume point doubles it
+ * back until the mode runs uncapped.  Called with the ctrl_handler lock held.
  */
-static int daxc02_g_input_status(struct v4l2_subdev *sd, uint32_t *status)
+static void daxc02_thermal_govern(struct daxc02 *priv)
 {
-    struct i2c_client *client = v4l2_get_subdevdata(sd);
-    struct camera_common_data *s_data = to_camera_common_data(&client->dev);
-    struct daxc02 *priv = (struct daxc02 *)s_data->priv;
-    struct camera_common_power_rail *pw = &priv->power;
-
-    dev_dbg(&client->dev, "%s\n", __func__);
+    struct camera_common_data *s_data = priv->s_data;
+    struct i2c_client *client = priv->i2c_client;
+    struct daxc02_queued_ctrl ctrl = { .id = TEGRA_CAMERA_CID_FRAME_RATE };
+    struct daxc02_event_data data = { 0 };
+    unsigned int mode_fps = s_data->frmfmt[s_data->mode].framerates[0];
+    unsigned int level = priv->thermal_level;
+    unsigned int cap_fps;
+
+    if(priv->temperature >= priv->throttle_temp && (mode_fps >> level) > priv->min_fps) level++;
+    else if(priv->temperature <= priv->resume_temp && level) level--;
+    else return;
+
+    if(level > priv->thermal_level) priv->stats.thermal_throttles++;
+    priv->thermal_level = level;
+
+    cap_fps = level ? max_t(unsigned int, mode_fps >> level, priv->min_fps) : 0;
+    priv->frame_rate_cap = (int64_t)cap_fps * FIXED_POINT_SCALING_FACTOR;
+
+    if(cap_fps) dev_info(&client->dev, "%d mC, frame rate capped at %u fps\n", priv->temperature, cap_fps);
+    else dev_info(&client->dev, "%d mC, frame rate cap lifted\n", priv->temperature);
+
+    /* reapply the requested rate through the cap, on both sensors of a pair */
+    ctrl.value = priv->frame_rate ? priv->frame_rate : (int64_t)mode_fps * FIXED_POINT_SCALING_FACTOR;
+    if(daxc02_apply_ctrls(priv, &ctrl, 1))
+        dev_err(&client->dev, "%s: failed to apply frame rate cap\n", __func__);
+
+    data.frame = priv->frame_seq;
+    data.id = level;
+    data.value = cap_fps;
+    daxc02_queue_event(client, DAXC02_EVENT_THERMAL, &data);
+}
 
-    *status = pw->state == SWITCH_ON;
-    return 0;
+/** daxc02_thermal_schedule - queues the next temperature sample.
+ * @priv: pointer to the daxc02 struct.
+ */
+static void daxc02_thermal_schedule(struct daxc02 *priv)
+{
+    schedule_delayed_work(&priv->thermal, msecs_to_jiffies(thermal_interval_ms));
 }
 
-/*
- * Registers the v4l2 sub device video operations.
+/** daxc02_thermal - samples the sensor temperature while streaming.
+ * @work: pointer to the thermal work struct.
  */
-static struct v4l2_subdev_video_ops daxc02_subdev_video_ops = {
-    .s_stream               = mt9m021_s_stream,
-    .g_mbus_config          = camera_common_g_mbus_config,
-    .g_input_status         = daxc02_g_input_status,
-};
+static void daxc02_thermal(struct work_struct *work)
+{
+    struct daxc02 *priv = container_of(to_delayed_work(work), struct daxc02, thermal);
+    struct thermal_zone_device *tz;
+    int ret;
 
+    /* serialize with daxc02_s_ctrl and daxc02_remove */
+    mutex_lock(priv->ctrl_handler.lock);
+    tz = priv->tz;
 
-/***************************************************
-        V4L2 Subdev Core Operations
-****************************************************/
+    if(!priv->streaming) goto unlock;
 
-static struct v4l2_subdev_core_ops daxc02_subdev_core_ops = {
-    .s_power                = camera_common_s_power,
-};
+    ret = daxc02_temp_sample(priv);
+    if(ret) dev_dbg(&priv->i2c_client->dev, "%s: sample failed %d\n", __func__, ret);
 
+    /* a stereo secondary follows its primary's cap */
+    if(!ret && priv->throttle_temp && !priv->stereo_primary) daxc02_thermal_govern(priv);
 
-/***************************************************
-        V4L2 Subdev Pad Operations
-****************************************************/
+    if(thermal_interval_ms) daxc02_thermal_schedule(priv);
 
-static int mt9m021_get_format(struct v4l2_subdev *sd, struct v4l2_subdev_pad_config *cfg, struct v4l2_subdev_format *format)
-{
-    return camera_common_g_fmt(sd, &format->format);
+    unlock:
+        mutex_unlock(priv->ctrl_handler.lock);
+
+    if(tz) thermal_zone_device_update(tz);
 }
 
-static int mt9m021_set_format(struct v4l2_subdev *sd, struct v4l2_subdev_pad_config *cfg, struct v4l2_subdev_format *format)
+/** daxc02_thermal_get_temp - reports the last sample to the thermal framework.
+ * @data: pointer to the daxc02 struct.
+ * @temp: temperature in millicelsius.
+ */
+static int daxc02_thermal_get_temp(void *data, int *temp)
 {
-    if (format->which == V4L2_SUBDEV_FORMAT_TRY)
-        return camera_common_try_fmt(sd, &format->format);
-    else
-        return camera_common_s_fmt(sd, &format->format);
+    struct daxc02 *priv = data;
+
+    if(!priv->temp_valid) return -EAGAIN;
+
+    *temp = priv->temperature;
+    return 0;
 }
 
-/*
- * Registers the v4l2 sub-device pad operations.
- */
-static struct v4l2_subdev_pad_ops mt9m021_subdev_pad_ops = {
-    .get_fmt                = mt9m021_get_format,
-    .set_fmt                = mt9m021_set_format,
-    .enum_mbus_code         = camera_common_enum_mbus_code,
-    .enum_frame_size        = camera_common_enum_framesizes,
-    .enum_frame_interval    = camera_common_enum_frameintervals,
+static const struct thermal_zone_of_device_ops daxc02_thermal_ops = {
+    .get_temp               = daxc02_thermal_get_temp,
 };
 
+/** daxc02_thermal_init - Reads the governor policy and registers the thermal zone sensor.
+ * @priv: Dax-C02 private data structure.
+ *
+ * The governor is off unless thermal-throttle-millicelsius is set.  The
+ * sensor only registers when a thermal zone in the device tree names it.
+ */
+static void daxc02_thermal_init(struct daxc02 *priv)
+{
+    struct i2c_client *client = priv->i2c_client;
+    struct device_node *node = client->dev.of_node;
+    uint32_t value;
 
-/***************************************************
-        V4L2 Subdev Operations
-****************************************************/
+    priv->min_fps = DAXC02_THERMAL_MIN_FPS;
+    if(!of_property_read_u32(node, "thermal-min-fps", &value) && value) priv->min_fps = value;
 
-static struct v4l2_subdev_ops daxc02_subdev_ops = {
-    .core                   = &daxc02_subdev_core_ops,
-    .video                  = &daxc02_subdev_video_ops,
-    .pad                    = &mt9m021_subdev_pad_ops,
-};
+    if(!of_property_read_u32(node, "thermal-throttle-millicelsius", &value))
+    {
+        priv->throttle_temp = value;
+        priv->resume_temp = priv->throttle_temp - DAXC02_THERMAL_HYSTERESIS;
+
+        if(!of_property_read_u32(node, "thermal-resume-millicelsius", &value))
+        {
+            if((int)value < priv->throttle_temp) priv->resume_temp = value;
+            else dev_err(&client->dev, "thermal-resume-millicelsius must be below the throttle point\n");
+        }
+
+        dev_info(&client->dev, "thermal governor throttles at %d mC, resumes at %d mC, floor %u fps\n",
+            priv->throttle_temp, priv->resume_temp, priv->min_fps);
+    }
+
+    priv->tz = thermal_zone_of_sensor_register(&client->dev, 0, priv, &daxc02_thermal_ops);
+    if(IS_ERR(priv->tz))
+    {
+        dev_dbg(&client->dev, "no thermal zone for this sensor (%ld)\n", PTR_ERR(priv->tz));
+        priv->tz = NULL;
+    }
+}
 
 
 /***************************************************
-        Camera Common Operations
+        Exposure Strobe
 ****************************************************/
 
-static struct camera_common_sensor_ops daxc02_common_ops = {
-    .power_on               = daxc02_power_on,
-    .power_off              = daxc02_power_off,
-};
+/** daxc02_strobe_irq - timestamps an edge of the sensor strobe output.
+ * @irq:    strobe interrupt.
+ * @dev_id: pointer to the daxc02 struct.
+ *
+ * The strobe is high while the sensor integrates, one pulse per frame.  A
+ * missed edge is counted, and the pulse still advances the frame number.
+ */
+static irqreturn_t daxc02_strobe_irq(int irq, void *dev_id)
+{
+    struct daxc02 *priv = dev_id;
+    struct daxc02_event_data data = { 0 };
+    uint64_t now = ktime_get_ns();
+    uint64_t width;
+    bool rising = gpio_get_value(priv->strobe_gpio);
+    bool done = false;
 
+    spin_lock(&priv->queue_lock);
 
-/***********************************************************
-    V4L2 subdev internal operations
-************************************************************/
+    if(!priv->strobe_armed) goto unlock;
 
-/** daxc02_open - Called by the v4l2 framework when the device is opened.
- * @sd:     pointer to the v4l2 sub-device.
- * @fh:     pointer to the v4l2 sub-device file handle.
+    if(rising)
+    {
+        if(priv->strobe_rise) priv->stats.strobe_misses++;
+        priv->strobe_rise = now;
+        priv->strobe_frame++;
+    }
+    else if(priv->strobe_rise)
+    {
+        width = now - priv->strobe_rise;
+        priv->exposure_timestamp = priv->strobe_rise + (width >> 1);
+        priv->strobe_rise = 0;
+
+        data.frame = priv->strobe_frame;
+        data.id = (uint32_t)div_u64(width, 1000);
+        data.value = priv->exposure_timestamp;
+        done = true;
+    }
+    else
+    {
+        priv->stats.strobe_misses++;
+        priv->strobe_frame++;
+    }
+
+    unlock:
+        spin_unlock(&priv->queue_lock);
+
+    if(done) daxc02_queue_event(priv->i2c_client, DAXC02_EVENT_EXPOSURE, &data);
+    return IRQ_HANDLED;
+}
+
+/** daxc02_strobe_arm - starts or stops timestamping strobe pulses.
+ * @priv: pointer to the daxc02 struct.
+ * @arm:  true just before the sensor starts, numbering pulses from frame_seq.
  */
-static int daxc02_open(struct v4l2_subdev *sd, struct v4l2_subdev_fh *fh)
+static void daxc02_strobe_arm(struct daxc02 *priv, bool arm)
 {
-    struct i2c_client *client = v4l2_get_subdevdata(sd);
-    dev_dbg(&client->dev, "%s\n", __func__);
-    return 0;
+    unsigned long flags;
+
+    spin_lock_irqsave(&priv->queue_lock, flags);
+    priv->strobe_armed = arm && priv->strobe_irq;
+    priv->strobe_frame = priv->frame_seq;
+    priv->strobe_rise = 0;
+    spin_unlock_irqrestore(&priv->queue_lock, flags);
 }
 
-/*
- * Registers the v4l2 sub-device internal operations.
+/** daxc02_strobe_init - Requests the optional strobe GPIO and its interrupt.
+ * @priv: Dax-C02 private data structure.
+ *
+ * The line is read from the interrupt handler, so it cannot be behind a
+ * sleeping GPIO controller.
  */
-static const struct v4l2_subdev_internal_ops mt9m021_subdev_internal_ops = {
-    .open               = daxc02_open,
-};
+static int daxc02_strobe_init(struct daxc02 *priv)
+{
+    struct i2c_client *client = priv->i2c_client;
+    int gpio;
+    int irq;
+    int ret;
 
+    gpio = of_get_named_gpio(client->dev.of_node, "strobe-gpios", 0);
+    if(gpio == -EPROBE_DEFER) return gpio;
+    if(gpio < 0)
+    {
+        dev_dbg(&client->dev, "strobe gpio not in DT\n");
+        return 0;
+    }
 
-/***************************************************
-        Media Entity Operations
-****************************************************/
+    if(gpio_cansleep(gpio))
+    {
+        dev_err(&client->dev, "strobe gpio %d can sleep, exposure timestamps disabled\n", gpio);
+        return 0;
+    }
 
-static const struct media_entity_operations daxc02_media_ops = {
-    .link_validate      = v4l2_subdev_link_validate,
-};
+    ret = devm_gpio_request_one(&client->dev, gpio, GPIOF_IN, "daxc02_strobe");
+    if(ret < 0)
+    {
+        dev_err(&client->dev, "can't request strobe gpio %d\n", ret);
+        return 0;
+    }
+
+    irq = gpio_to_irq(gpio);
+    if(irq <= 0)
+    {
+        dev_err(&client->dev, "strobe gpio %d has no interrupt\n", gpio);
+        return 0;
+    }
+
+    priv->strobe_gpio = gpio;
+    ret = devm_request_irq(&client->dev, irq, daxc02_strobe_irq,
+        IRQF_TRIGGER_RISING | IRQF_TRIGGER_FALLING, "daxc02_strobe", priv);
+    if(ret)
+    {
+        dev_err(&client->dev, "can't request strobe irq %d\n", ret);
+        return 0;
+    }
+
+    priv->strobe_irq = irq;
+    dev_info(&client->dev, "exposure timestamps from strobe gpio %d\n", gpio);
+    return 0;
+}
 
 
 /***************************************************
@@ -994,6 +3582,20 @@ static struct of_device_id daxc02_of_match[] = {
         { },
 };
 
+/** daxc02_set_default_mode - Sets the mode and format the sensor starts in.
+ * @s_data: camera common data.
+ * @mode:   index into s_data->frmfmt.
+ */
+static void daxc02_set_default_mode(struct camera_common_data *s_data, uint32_t mode)
+{
+    s_data->def_mode    = mode;
+    s_data->def_width   = s_data->frmfmt[mode].size.width;
+    s_data->def_height  = s_data->frmfmt[mode].size.height;
+    s_data->fmt_width   = s_data->def_width;
+    s_data->fmt_height  = s_data->def_height;
+    s_data->mode        = mode;
+}
+
 /** daxc02_parse_dt - Parses the device tree to load camera common data.
  * @client: pointer to the i2c client.
  */
@@ -1002,6 +3604,7 @@ static struct camera_common_pdata *daxc02_parse_dt(struct i2c_client *client, st
     const struct of_device_id *match;
     struct device_node *node = client->dev.of_node;
     struct camera_common_pdata *board_priv_pdata;
+    uint32_t mode;
     int gpio;
     int ret;
 
@@ -1031,9 +3634,8 @@ static struct camera_common_pdata *daxc02_parse_dt(struct i2c_client *client, st
     }
     else if (gpio < 0)
     {
-            /* reset-gpio is not absoluctly needed */
+            /* reset-gpio is not absoluctly needed, left invalid so it is never requested */
             dev_dbg(&client->dev, "reset gpios not in DT\n");
-            gpio = 0;
     }
     board_priv_pdata->reset_gpio = (unsigned int)gpio;
 
@@ -1060,6 +3662,13 @@ static struct camera_common_pdata *daxc02_parse_dt(struct i2c_client *client, st
 
     board_priv_pdata->has_eeprom = of_property_read_bool(node, "has-eeprom");
 
+    /* optional, index into the frame formats */
+    if(!of_property_read_u32(node, "default-mode", &mode))
+    {
+        if(mode < s_data->numfmts) daxc02_set_default_mode(s_data, mode);
+        else dev_err(&client->dev, "default-mode %u out of range, using %d\n", mode, s_data->def_mode);
+    }
+
     return board_priv_pdata;
 
     error:
@@ -1067,12 +3676,109 @@ static struct camera_common_pdata *daxc02_parse_dt(struct i2c_client *client, st
         return board_priv_pdata;
 }
 
+/** daxc02_check_bandwidth - Checks the enabled sensors against the CSI budget.
+ * @priv: Dax-C02 private data structure.
+ *
+ * tegra-camera-platform sizes the VI/ISP bandwidth from num_csi_lanes and
+ * max_lane_speed.  Warns when every enabled DAX-C02 running its fastest mode
+ * would not fit.
+ */
+static void daxc02_check_bandwidth(struct daxc02 *priv)
+{
+    struct i2c_client *client = priv->i2c_client;
+    struct camera_common_data *s_data = priv->s_data;
+    struct device_node *node;
+    uint32_t num_csi_lanes, max_lane_speed;
+    uint64_t sensor_kbps = 0;
+    uint64_t rate;
+    unsigned int sensors = 0;
+    int i;
+
+    node = of_find_node_by_path("/tegra-camera-platform");
+    if(!node) return;
+
+    i = of_property_read_u32(node, "num_csi_lanes", &num_csi_lanes);
+    i |= of_property_read_u32(node, "max_lane_speed", &max_lane_speed);
+    of_node_put(node);
+    if(i) return;
+
+    for_each_compatible_node(node, NULL, "novadynamics,daxc02")
+    {
+        if(of_device_is_available(node)) sensors++;
+    }
+
+    for(i = 0; i < s_data->numfmts; i++)
+    {
+        rate = (uint64_t)s_data->frmfmt[i].size.width * s_data->frmfmt[i].size.height *
+            s_data->frmfmt[i].framerates[0] * DAXC02_BITS_PER_PIXEL;
+        sensor_kbps = max_t(uint64_t, sensor_kbps, div_u64(rate, 1000));
+    }
+
+    dev_dbg(&client->dev, "%s: %u sensors at %llu kbps, %u lanes at %u kbps\n", __func__,
+        sensors, sensor_kbps, num_csi_lanes, max_lane_speed);
+
+    if(sensors * DAXC02_CSI_LANES > num_csi_lanes)
+        dev_warn(&client->dev, "%u sensors need %u CSI lanes, num_csi_lanes is %u\n",
+            sensors, sensors * DAXC02_CSI_LANES, num_csi_lanes);
+
+    if(div_u64(sensor_kbps, DAXC02_CSI_LANES) > max_lane_speed)
+        dev_warn(&client->dev, "%llu kbps per lane exceeds max_lane_speed %u\n",
+            div_u64(sensor_kbps, DAXC02_CSI_LANES), max_lane_speed);
+}
+
+/** daxc02_ctrl_config_dt - narrows this instance's control ranges from the device tree.
+ * @priv: pointer to the daxc02 struct.
+ *
+ * Each property in daxc02_ctrl_dt_props is <min default max> in the
+ * property's units.  Ranges can only narrow the driver's, a property that
+ * doesn't fit is reported and ignored.
+ */
+static void daxc02_ctrl_config_dt(struct daxc02 *priv)
+{
+    struct device *dev = &priv->i2c_client->dev;
+    struct v4l2_ctrl_config *config;
+    uint32_t range[3];
+    int64_t min, def, max;
+    unsigned int i;
+
+    for(i = 0; i < ARRAY_SIZE(daxc02_ctrl_dt_props); i++)
+    {
+        const struct daxc02_ctrl_dt *prop = &daxc02_ctrl_dt_props[i];
+
+        if(of_property_read_u32_array(dev->of_node, prop->prop, range, ARRAY_SIZE(range))) continue;
+
+        config = daxc02_ctrl_config_get(priv, prop->id);
+        if(!config) continue;
+
+        min = div_u64((uint64_t)range[0] * FIXED_POINT_SCALING_FACTOR, prop->scale);
+        def = div_u64((uint64_t)range[1] * FIXED_POINT_SCALING_FACTOR, prop->scale);
+        max = div_u64((uint64_t)range[2] * FIXED_POINT_SCALING_FACTOR, prop->scale);
+
+        if(min > def || def > max || min < config->min || max > config->max)
+        {
+            dev_err(dev, "%s <%u %u %u> is outside the driver's range, ignored\n",
+                prop->prop, range[0], range[1], range[2]);
+            continue;
+        }
+
+        dev_dbg(dev, "%s: %s <%u %u %u>\n", __func__, prop->prop, range[0], range[1], range[2]);
+        config->min = min;
+        config->def = def;
+        config->max = max;
+    }
+
+    /* the default mode's rate may fall outside a narrowed Frame Rate range */
+    config = daxc02_ctrl_config_get(priv, TEGRA_CAMERA_CID_FRAME_RATE);
+    if(config) config->def = clamp_t(int64_t, config->def, config->min, config->max);
+}
+
 /** daxc02_ctrls_init - Registers and initializes controls with the v4l2 framework.
  * @priv: Dax-C02 private data structure.
  */
 static int daxc02_ctrls_init(struct daxc02 *priv)
 {
     struct i2c_client *client = priv->i2c_client;
+    struct camera_common_data *s_data = priv->s_data;
     struct v4l2_ctrl *ctrl;
     int num_ctrls;
     int ret;
@@ -1080,24 +3786,36 @@ static int daxc02_ctrls_init(struct daxc02 *priv)
 
     dev_dbg(&client->dev, "%s\n", __func__);
 
+    /* per-instance copy, defaults follow this instance's default mode */
     num_ctrls = ARRAY_SIZE(ctrl_config_list);
+    priv->ctrl_config = devm_kmemdup(&client->dev, ctrl_config_list, sizeof(ctrl_config_list), GFP_KERNEL);
+    if(!priv->ctrl_config) return -ENOMEM;
+
+    for(i = 0; i < num_ctrls; i++)
+    {
+        if(priv->ctrl_config[i].id == TEGRA_CAMERA_CID_FRAME_RATE)
+            priv->ctrl_config[i].def = (int64_t)s_data->frmfmt[s_data->def_mode].framerates[0] * FIXED_POINT_SCALING_FACTOR;
+    }
+
+    daxc02_ctrl_config_dt(priv);
+
     dev_dbg(&client->dev, "initializing %d controls\n", num_ctrls);
     v4l2_ctrl_handler_init(&priv->ctrl_handler, num_ctrls);
 
     for(i = 0; i < num_ctrls; i++)
     {
-        dev_dbg(&client->dev, "control %d: %s\n", i, ctrl_config_list[i].name);
-        ctrl = v4l2_ctrl_new_custom(&priv->ctrl_handler, &ctrl_config_list[i], NULL);
+        dev_dbg(&client->dev, "control %d: %s\n", i, priv->ctrl_config[i].name);
+        ctrl = v4l2_ctrl_new_custom(&priv->ctrl_handler, &priv->ctrl_config[i], NULL);
         if(ctrl == NULL)
         {
-            dev_err(&client->dev, "Failed to init %s ctrl\n", ctrl_config_list[i].name);
+            dev_err(&client->dev, "Failed to init %s ctrl\n", priv->ctrl_config[i].name);
             continue;
         }
 
-        if(ctrl_config_list[i].type == V4L2_CTRL_TYPE_STRING &&
-          (ctrl_config_list[i].flags & V4L2_CTRL_FLAG_READ_ONLY))
+        if(priv->ctrl_config[i].type == V4L2_CTRL_TYPE_STRING &&
+          (priv->ctrl_config[i].flags & V4L2_CTRL_FLAG_READ_ONLY))
         {
-            ctrl->p_new.p_char = devm_kzalloc(&client->dev, ctrl_config_list[i].max + 1, GFP_KERNEL);
+            ctrl->p_new.p_char = devm_kzalloc(&client->dev, priv->ctrl_config[i].max + 1, GFP_KERNEL);
             if (!ctrl->p_new.p_char) return -ENOMEM;
         }
         priv->ctrls[i] = ctrl;
@@ -1112,6 +3830,9 @@ static int daxc02_ctrls_init(struct daxc02 *priv)
         goto error;
     }
 
+    /* the defaults below are converted with the mode's timing */
+    daxc02_update_mode(priv);
+
     ret = v4l2_ctrl_handler_setup(&priv->ctrl_handler);
     if(ret)
     {
@@ -1136,6 +3857,7 @@ static int daxc02_probe(struct i2c_client *client, const struct i2c_device_id *i
     struct device_node *node = client->dev.of_node;
     struct daxc02 *priv;
     uint16_t reg16;
+    unsigned int i;
     int ret;
 
     dev_dbg(&client->dev, "%s\n", __func__);
@@ -1169,11 +3891,18 @@ static int daxc02_probe(struct i2c_client *client, const struct i2c_device_id *i
     s_data->def_clk_freq        = MT9M021_EXT_FREQ;
 
     priv->i2c_client            = client;
+    priv->isp_profile           = daxc02_isp_profile;
     priv->s_data                = s_data;
     priv->subdev                = &s_data->subdev;
     priv->subdev->dev           = &client->dev;
     priv->s_data->dev           = &client->dev;
 
+    mutex_init(&priv->lock);
+    INIT_DELAYED_WORK(&priv->monitor, daxc02_monitor);
+    spin_lock_init(&priv->queue_lock);
+    INIT_DELAYED_WORK(&priv->apply, daxc02_apply_queue);
+    INIT_DELAYED_WORK(&priv->thermal, daxc02_thermal);
+
     priv->pdata = daxc02_parse_dt(client, s_data);
     if(PTR_ERR(priv->pdata) == -EPROBE_DEFER) return -EPROBE_DEFER;
     else if (!priv->pdata)
@@ -1182,6 +3911,12 @@ static int daxc02_probe(struct i2c_client *client, const struct i2c_device_id *i
         return -EFAULT;
     }
 
+    /* optional, controls set on this sensor are mirrored to the secondary */
+    priv->stereo_node = of_parse_phandle(node, "stereo-secondary", 0);
+
+    ret = daxc02_strobe_init(priv);
+    if(ret) return ret;
+
     ret = daxc02_power_get(priv);
     if(ret) return ret;
 
@@ -1203,11 +3938,27 @@ static int daxc02_probe(struct i2c_client *client, const struct i2c_device_id *i
         return ret;
     }
 
+    /* low latency readout rewrites the mode line length, keep the device tree values */
+    priv->mode_line_length = devm_kcalloc(&client->dev, s_data->sensor_props.num_modes,
+        sizeof(uint32_t), GFP_KERNEL);
+    if(!priv->mode_line_length) return -ENOMEM;
+
+    for(i = 0; i < s_data->sensor_props.num_modes; i++)
+        priv->mode_line_length[i] = s_data->sensor_props.sensor_modes[i].image_properties.line_length;
+
+    /* a bad blob falls back to the built in tables */
+    ret = daxc02_fw_load(priv);
+    if(ret == -ENOMEM) return ret;
+
+    daxc02_check_bandwidth(priv);
+
     v4l2_i2c_subdev_init(priv->subdev, client, &daxc02_subdev_ops);
 
     ret = daxc02_ctrls_init(priv);
     if(ret) return ret;
 
+    daxc02_thermal_init(priv);
+
     priv->subdev->internal_ops = &mt9m021_subdev_internal_ops;
     priv->subdev->flags |= V4L2_SUBDEV_FL_HAS_DEVNODE;
     priv->subdev->flags |= V4L2_SUBDEV_FL_HAS_EVENTS;
@@ -1228,6 +3979,9 @@ static int daxc02_probe(struct i2c_client *client, const struct i2c_device_id *i
     ret = v4l2_async_register_subdev(priv->subdev);
     if(ret) return ret;
 
+    ret = sysfs_create_group(&client->dev.kobj, &daxc02_stats_group);
+    if(ret) dev_warn(&client->dev, "unable to create stats attributes\n");
+
     dev_info(&client->dev, "probe successful.\n");
     return 0;
 }
@@ -1239,9 +3993,25 @@ static int daxc02_remove(struct i2c_client *client)
 {
     struct camera_common_data *s_data = to_camera_common_data(&client->dev);
     struct daxc02 *priv = (struct daxc02 *)s_data->priv;
+    struct thermal_zone_device *tz;
 
     dev_dbg(&client->dev, "%s\n", __func__);
 
+    /* the sample work updates the zone, stop it before the zone goes away */
+    cancel_delayed_work_sync(&priv->thermal);
+    mutex_lock(priv->ctrl_handler.lock);
+    tz = priv->tz;
+    priv->tz = NULL;
+    mutex_unlock(priv->ctrl_handler.lock);
+    if(tz) thermal_zone_of_sensor_unregister(&client->dev, tz);
+
+    if(priv->strobe_irq) devm_free_irq(&client->dev, priv->strobe_irq, priv);
+
+    cancel_delayed_work_sync(&priv->monitor);
+    cancel_delayed_work_sync(&priv->apply);
+    daxc02_stereo_unbind(priv);
+    of_node_put(priv->stereo_node);
+    sysfs_remove_group(&client->dev.kobj, &daxc02_stats_group);
     v4l2_async_unregister_subdev(priv->subdev);
 
     #if defined(CONFIG_MEDIA_CONTROLLER)
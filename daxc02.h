@@ -40,12 +40,18 @@
 #define MT9M021_DATA_PEDESTAL           0x301E
 #define MT9M021_COLUMN_CORRECTION       0x30D4
 #define MT9M021_FLASH                   0x3046
+#define MT9M021_FRAME_COUNT             0x303A
+#define MT9M021_FRAME_STATUS            0x303C
 
-#define MT9M021_VT_SYS_CLK_DIV          0x302A
-#define MT9M021_VT_PIX_CLK_DIV          0x302C
+#define MT9M021_VT_PIX_CLK_DIV          0x302A
+#define MT9M021_VT_SYS_CLK_DIV          0x302C
 #define MT9M021_PRE_PLL_CLK_DIV         0x302E
 #define MT9M021_PLL_MULTIPLIER          0x3030
 #define MT9M021_DIGITAL_TEST            0x30B0
+#define MT9M021_TEMPSENS_DATA           0x30B2
+#define MT9M021_TEMPSENS_CTRL           0x30B4
+#define MT9M021_TEMPSENS_CALIB1         0x30C6
+#define MT9M021_TEMPSENS_CALIB2         0x30C8
 
 #define MT9M021_Y_ADDR_START            0x3002
 #define MT9M021_X_ADDR_START            0x3004
@@ -69,6 +75,7 @@
 #define MT9M021_AE_LUMA_TARGET          0x3102
 #define MT9M021_EMBEDDED_DATA_CTRL      0x3064
 #define MT9M021_DATAPATH_SELECT         0x306E
+#define MT9M021_GROUPED_PARAM_HOLD      0x3022
 
 #define MT9M021_GREEN1_GAIN             0x3056
 #define MT9M021_BLUE_GAIN               0x3058
@@ -93,6 +100,11 @@
 #define MT9M021_PIXEL_ARRAY_WIDTH       1280
 #define MT9M021_PIXEL_ARRAY_HEIGHT      960
 #define MT9M021_LLP_RECOMMENDED         1650
+#define MT9M021_LLP_MIN                 1388
+#define MT9M021_READ_SPEED_DEF          0x0010
+#define MT9M021_READ_SPEED_FAST         0x0000
+#define MT9M021_FRAME_LENGTH_MAX        0xFFFF
+#define MT9M021_COARSE_TIME_MARGIN      1
 
 #define MT9M021_EXT_FREQ                24000000
 #define MT9M021_TARGET_FREQ             74250000
@@ -100,6 +112,8 @@
 #define MT9M021_PLL_N                   4
 #define MT9M021_PLL_P1                  1
 #define MT9M021_PLL_P2                  8
+#define MT9M021_TARGET_FREQ_LOW         37125000
+#define MT9M021_PLL_P2_LOW              16
 
 #define MT9M021_ROW_START_MIN           0
 #define MT9M021_ROW_START_MAX           960
@@ -117,6 +131,16 @@
 #define MT9M021_STREAM_ON               0x00DC
 #define MT9M021_MASTER_MODE             0x10DC
 #define MT9M021_TRIGGER_MODE            0x19D8
+#define MT9M021_TRIGGER_STREAM          0x19DC
+
+#define MT9M021_FRAME_STATUS_STANDBY    0x0002
+
+#define MT9M021_TEMPSENS_POWER          0x0001
+#define MT9M021_TEMPSENS_START          0x0010
+#define MT9M021_TEMPSENS_CLEAR          0x0020
+#define MT9M021_TEMPSENS_DATA_MASK      0x07FF
+#define MT9M021_TEMPSENS_CALIB1_MC      70000
+#define MT9M021_TEMPSENS_CALIB2_MC      55000
 
 #define MT9M021_ANALOGUE_GAIN_MIN         0x0
 #define MT9M021_ANALOGUE_GAIN_MAX         0x3
@@ -124,6 +148,12 @@
 #define MT9M021_ANALOGUE_GAIN_SHIFT       4
 #define MT9M021_ANALOGUE_GAIN_MASK        0x0030
 
+#define MT9M021_DIGITAL_GAIN_UNITY      0x0020
+#define MT9M021_DIGITAL_GAIN_MAX        0x00FF
+
+#define MT9M021_GROUPED_HOLD_ON         0x0100
+#define MT9M021_GROUPED_HOLD_OFF        0x0000
+
 #define MT9M021_RESERVED_30EA           0x30EA
 #define MT9M021_RESERVED_3180           0x3180
 #define MT9M021_RESERVED_3ED6           0x3ED6
@@ -135,4 +165,122 @@
 #define MT9M021_RESERVED_3EE2           0x3EE2
 #define MT9M021_RESERVED_3EE4           0x3EE4
 
+
+/***************************************************
+        DAX-C02 Custom Controls
+****************************************************/
+
+#define DAXC02_CID_BASE                 (V4L2_CID_USER_BASE | 0x2000)
+#define DAXC02_CID_ISP_PROFILE          (DAXC02_CID_BASE + 0)
+#define DAXC02_CID_FRAME_COUNT          (DAXC02_CID_BASE + 1)
+#define DAXC02_CID_TARGET_FRAME         (DAXC02_CID_BASE + 2)
+#define DAXC02_CID_CTRL_LATENCY         (DAXC02_CID_BASE + 3)
+#define DAXC02_CID_STEREO_LOCKSTEP      (DAXC02_CID_BASE + 4)
+#define DAXC02_CID_SNAPSHOT_MODE        (DAXC02_CID_BASE + 5)
+#define DAXC02_CID_SNAPSHOT_TRIGGER     (DAXC02_CID_BASE + 6)
+#define DAXC02_CID_LOW_LATENCY          (DAXC02_CID_BASE + 7)
+#define DAXC02_CID_READOUT_TIME         (DAXC02_CID_BASE + 8)
+#define DAXC02_CID_TEMPERATURE          (DAXC02_CID_BASE + 9)
+#define DAXC02_CID_EXPOSURE_ACTUAL      (DAXC02_CID_BASE + 10)
+#define DAXC02_CID_FRAME_PERIOD         (DAXC02_CID_BASE + 11)
+#define DAXC02_CID_LINE_TIME            (DAXC02_CID_BASE + 12)
+#define DAXC02_CID_EXPOSURE_TIMESTAMP   (DAXC02_CID_BASE + 13)
+#define DAXC02_CID_GAIN_LATENCY         (DAXC02_CID_BASE + 14)
+#define DAXC02_CID_EXPOSURE_LATENCY     (DAXC02_CID_BASE + 15)
+#define DAXC02_CID_FRAME_RATE_LATENCY   (DAXC02_CID_BASE + 16)
+
+
+/***************************************************
+        DAX-C02 Events
+****************************************************/
+
+#define DAXC02_EVENT_BASE               (V4L2_EVENT_PRIVATE_START | 0x2000)
+#define DAXC02_EVENT_STREAM_STARTED     (DAXC02_EVENT_BASE + 0)
+#define DAXC02_EVENT_CTRL_APPLIED       (DAXC02_EVENT_BASE + 1)
+#define DAXC02_EVENT_ERROR              (DAXC02_EVENT_BASE + 2)
+#define DAXC02_EVENT_RECOVERY           (DAXC02_EVENT_BASE + 3)
+#define DAXC02_EVENT_THERMAL            (DAXC02_EVENT_BASE + 4)
+#define DAXC02_EVENT_EXPOSURE           (DAXC02_EVENT_BASE + 5)
+
+#define DAXC02_EVENT_SRC_SENSOR         0
+#define DAXC02_EVENT_SRC_BRIDGE         1
+
+/*
+ * Payload of v4l2_event.u.data, by event type:
+ *  STREAM_STARTED: frame at start, value is the stream-on latency in us.
+ *  CTRL_APPLIED:   frame the control takes effect on, id and value of the control.
+ *  ERROR:          source, id is the register address, value is the error code.
+ *  RECOVERY:       id is the recovery level, source is where the stall was
+ *                  seen.  value is 0 when the level is attempted and 1 once
+ *                  frames resume after it.
+ *  THERMAL:        id is the governor step, value is the frame rate cap in
+ *                  fps or 0 once the cap is lifted.
+ *  EXPOSURE:       frame exposed, id is the strobe width in us, value is the
+ *                  exposure midpoint in CLOCK_MONOTONIC ns.
+ */
+struct daxc02_event_data {
+    uint32_t frame;
+    uint32_t id;
+    int64_t value;
+    uint32_t source;
+};
+
+
+/***************************************************
+        DAX-C02 Firmware Format
+****************************************************/
+
+/*
+ * Optional register table blob, all fields little endian.  The header is
+ * followed by sections, each a section header and count entries.  A blob
+ * holds one COMMON, one BRIDGE, one FRMFMT and one MODE section per mode.
+ */
+#define DAXC02_FW_MAGIC                 0x32435844  /* "DXC2" */
+#define DAXC02_FW_VERSION               1
+#define DAXC02_FW_MAX_MODES             16
+#define DAXC02_FW_MAX_ENTRIES           1024
+
+#define DAXC02_FW_SECTION_COMMON        0
+#define DAXC02_FW_SECTION_MODE          1
+#define DAXC02_FW_SECTION_BRIDGE        2
+#define DAXC02_FW_SECTION_FRMFMT        3
+
+#define DAXC02_FW_FRMFMT_HFR            0x0001
+
+struct daxc02_fw_header {
+    __le32 magic;
+    __le16 version;
+    __le16 num_modes;
+    __le32 revision;
+    __le32 size;        /* of the whole blob */
+    __le32 crc32;       /* of everything after the header */
+} __packed;
+
+struct daxc02_fw_section {
+    __le16 type;
+    __le16 index;       /* mode number of a MODE section */
+    __le32 count;
+} __packed;
+
+/* COMMON and MODE entries, address MT9M021_TABLE_WAIT_MS sleeps val ms */
+struct daxc02_fw_reg {
+    __le16 addr;
+    __le16 val;
+} __packed;
+
+/* BRIDGE entries, len is the register width in bytes, 2 or 4 */
+struct daxc02_fw_bridge {
+    __le16 addr;
+    __le16 len;
+    __le32 data;
+} __packed;
+
+/* FRMFMT entries, in mode order */
+struct daxc02_fw_frmfmt {
+    __le16 width;
+    __le16 height;
+    __le16 fps;
+    __le16 flags;
+} __packed;
+
 #endif
\ No newline at end of file
@@ -172,8 +172,8 @@ static const struct reg_16 daxc02_mode_table_common[] = {
     {MT9M021_SEQ_CTRL_PORT,     0x2C00},
 
     /* PLL settings. */
-    {MT9M021_VT_PIX_CLK_DIV,    MT9M021_PLL_P1},
-    {MT9M021_VT_SYS_CLK_DIV,    MT9M021_PLL_P2},
+    {MT9M021_VT_SYS_CLK_DIV,    MT9M021_PLL_P1},
+    {MT9M021_VT_PIX_CLK_DIV,    MT9M021_PLL_P2},
     {MT9M021_PRE_PLL_CLK_DIV,   MT9M021_PLL_N},
     {MT9M021_PLL_MULTIPLIER,    MT9M021_PLL_M},
     {MT9M021_TABLE_WAIT_MS,     200},
@@ -219,7 +219,7 @@ static const struct reg_16 daxc02_mode_1280x720[] = {
     {MT9M021_Y_ODD_INC,         0x0001},
     {MT9M021_READ_MODE,         0x0000},
     {MT9M021_DIGITAL_BINNING,   MT9M021_BINNING_DEF},
-    {MT9M021_READ_SPEED,        0x0010},
+    {MT9M021_READ_SPEED,        MT9M021_READ_SPEED_DEF},
 
     {MT9M021_TABLE_END,         0x0000}
 };
@@ -234,7 +234,7 @@ static const struct reg_16 daxc02_mode_1280x960[] = {
     {MT9M021_Y_ODD_INC,         0x0001},
     {MT9M021_READ_MODE,         0x0000},
     {MT9M021_DIGITAL_BINNING,   MT9M021_BINNING_DEF},
-    {MT9M021_READ_SPEED,        0x0010},
+    {MT9M021_READ_SPEED,        MT9M021_READ_SPEED_DEF},
 
     {MT9M021_TABLE_END,         0x0000}
 };
@@ -249,7 +249,46 @@ static const struct reg_16 daxc02_mode_1280x580[] = {
     {MT9M021_Y_ODD_INC,         0x0001},
     {MT9M021_READ_MODE,         0x0000},
     {MT9M021_DIGITAL_BINNING,   MT9M021_BINNING_DEF},
-    {MT9M021_READ_SPEED,        0x0010},
+    {MT9M021_READ_SPEED,        MT9M021_READ_SPEED_DEF},
+
+    {MT9M021_TABLE_END,         0x0000}
+};
+
+/*
+ * Low frame rate modes run the PLL at half speed, MT9M021_TARGET_FREQ_LOW,
+ * by raising P2 over the value the common table wrote, then wait for the
+ * PLL to settle as the common table does.
+ */
+static const struct reg_16 daxc02_mode_1280x720_low[] = {
+    {MT9M021_VT_PIX_CLK_DIV,    MT9M021_PLL_P2_LOW},
+    {MT9M021_TABLE_WAIT_MS,     200},
+    {MT9M021_Y_ADDR_START,      0x0078},
+    {MT9M021_X_ADDR_START,      0x0001},
+    {MT9M021_Y_ADDR_END,        0x0347},
+    {MT9M021_X_ADDR_END,        0x0500},
+    {MT9M021_LINE_LENGTH_PCK,   MT9M021_LLP_RECOMMENDED},
+    {MT9M021_X_ODD_INC,         0x0001},
+    {MT9M021_Y_ODD_INC,         0x0001},
+    {MT9M021_READ_MODE,         0x0000},
+    {MT9M021_DIGITAL_BINNING,   MT9M021_BINNING_DEF},
+    {MT9M021_READ_SPEED,        MT9M021_READ_SPEED_DEF},
+
+    {MT9M021_TABLE_END,         0x0000}
+};
+
+static const struct reg_16 daxc02_mode_1280x960_low[] = {
+    {MT9M021_VT_PIX_CLK_DIV,    MT9M021_PLL_P2_LOW},
+    {MT9M021_TABLE_WAIT_MS,     200},
+    {MT9M021_Y_ADDR_START,      0x0000},
+    {MT9M021_X_ADDR_START,      0x0001},
+    {MT9M021_Y_ADDR_END,        0x03BF},
+    {MT9M021_X_ADDR_END,        0x0500},
+    {MT9M021_LINE_LENGTH_PCK,   MT9M021_LLP_RECOMMENDED},
+    {MT9M021_X_ODD_INC,         0x0001},
+    {MT9M021_Y_ODD_INC,         0x0001},
+    {MT9M021_READ_MODE,         0x0000},
+    {MT9M021_DIGITAL_BINNING,   MT9M021_BINNING_DEF},
+    {MT9M021_READ_SPEED,        MT9M021_READ_SPEED_DEF},
 
     {MT9M021_TABLE_END,         0x0000}
 };
@@ -259,6 +298,8 @@ enum {
     MT9M021_MODE_1280X960_30FPS,
     MT9M021_MODE_1280X580_30FPS,
     MT9M021_MODE_1280X580_60FPS,
+    MT9M021_MODE_1280X720_15FPS,
+    MT9M021_MODE_1280X960_15FPS,
 };
 
 static const struct reg_16 *mode_table[] = {
@@ -266,6 +307,12 @@ static const struct reg_16 *mode_table[] = {
     [MT9M021_MODE_1280X960_30FPS] = daxc02_mode_1280x960,
     [MT9M021_MODE_1280X580_30FPS] = daxc02_mode_1280x580,
     [MT9M021_MODE_1280X580_60FPS] = daxc02_mode_1280x580,
+    [MT9M021_MODE_1280X720_15FPS] = daxc02_mode_1280x720_low,
+    [MT9M021_MODE_1280X960_15FPS] = daxc02_mode_1280x960_low,
+};
+
+static const int daxc02_15fps[] = {
+    15,
 };
 
 static const int daxc02_30fps[] = {
@@ -281,6 +328,25 @@ static const struct camera_common_frmfmt daxc02_frmfmt[] = {
     {{1280, 960},    daxc02_30fps,    1, 0,    MT9M021_MODE_1280X960_30FPS},
     {{1280, 580},    daxc02_30fps,    1, 0,    MT9M021_MODE_1280X580_30FPS},
     {{1280, 580},    daxc02_60fps,    1, 0,    MT9M021_MODE_1280X580_60FPS},
+    {{1280, 720},    daxc02_15fps,    1, 0,    MT9M021_MODE_1280X720_15FPS},
+    {{1280, 960},    daxc02_15fps,    1, 0,    MT9M021_MODE_1280X960_15FPS},
+};
+
+/*
+ * ISP override profile recommended for each mode.  High frame rate modes use
+ * the lightweight profile with lens shading and DCT noise reduction disabled.
+ */
+#define DAXC02_ISP_PROFILE_LEN          32
+#define DAXC02_ISP_PROFILE_DEFAULT      "camera_overrides.isp"
+#define DAXC02_ISP_PROFILE_HFR          "camera_overrides_hfr.isp"
+
+static const char * const daxc02_isp_profile[] = {
+    [MT9M021_MODE_1280X720_30FPS] = DAXC02_ISP_PROFILE_DEFAULT,
+    [MT9M021_MODE_1280X960_30FPS] = DAXC02_ISP_PROFILE_DEFAULT,
+    [MT9M021_MODE_1280X580_30FPS] = DAXC02_ISP_PROFILE_DEFAULT,
+    [MT9M021_MODE_1280X580_60FPS] = DAXC02_ISP_PROFILE_HFR,
+    [MT9M021_MODE_1280X720_15FPS] = DAXC02_ISP_PROFILE_DEFAULT,
+    [MT9M021_MODE_1280X960_15FPS] = DAXC02_ISP_PROFILE_DEFAULT,
 };
 
 #endif  /* __MT9M021_TABLES__ */
@@ -0,0 +1,1072 @@
+/*
+ * daxc02_capbench.c - Zero-copy capture benchmark for the DAX-C02 video nodes.
+ *
+ * Streams several video nodes at once with mmap or dmabuf buffers.  For each
+ * sensor it reports the achieved frame rate, dropped frames, stream-on
+ * latency and the distribution of buffer-to-app latency.  Frame data is
+ * never copied or touched.  A schedule of actions switches frame sizes,
+ * frame rates and controls at fixed times, so runs can be repeated across
+ * driver changes.  Results are reported for each phase between actions.
+ *
+ * Build on the target:
+ *     gcc -O2 -Wall -o daxc02_capbench daxc02_capbench.c
+ *
+ * Usage:
+ *     daxc02_capbench [-d video[:subdev]]... [-t seconds] [-n buffers]
+ *                     [-m mmap|dmabuf] [-a [stream@]seconds:action]...
+ *                     [-c results.csv]
+ *
+ * Actions:
+ *     size=WxH     restart the stream in another frame size
+ *     fps=N        request N fps through Frame Rate, or VIDIOC_S_PARM
+ *     restart      stop and restart the stream
+ *     NAME=VALUE   set the control named NAME, e.g. "Gain=8388608"
+ *
+ * Without -d, /dev/video0 and /dev/video1 are streamed.  Any V4L2 capture
+ * node works, so the tool also runs against vivid when no board is present.
+ */
+
+#include <errno.h>
+#include <fcntl.h>
+#include <getopt.h>
+#include <signal.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+
+#include <sys/ioctl.h>
+#include <sys/mman.h>
+#include <sys/select.h>
+
+#include <linux/videodev2.h>
+
+#define BENCH_MAX_STREAMS           4
+#define BENCH_MAX_BUFFERS           16
+#define BENCH_MAX_ACTIONS           32
+#define BENCH_TIMEOUT_S             2
+#define BENCH_POLL_US               100000
+
+/* TEGRA_CAMERA_CID_FRAME_RATE is Q42.22 */
+#define BENCH_FPS_SHIFT             22
+
+/* DAXC02_EVENT_STREAM_STARTED and struct daxc02_event_data, from daxc02.h */
+#define BENCH_EVENT_STREAM_STARTED  (V4L2_EVENT_PRIVATE_START | 0x2000)
+
+struct bench_event_data {
+    uint32_t frame;
+    uint32_t id;
+    int64_t value;
+    uint32_t source;
+};
+
+enum bench_action_type {
+    BENCH_ACTION_SIZE,
+    BENCH_ACTION_FPS,
+    BENCH_ACTION_RESTART,
+    BENCH_ACTION_CTRL,
+};
+
+struct bench_action {
+    double at;
+    int stream;
+    enum bench_action_type type;
+    uint32_t width;
+    uint32_t height;
+    int fps;
+    char name[32];
+    int64_t value;
+    const char *text;
+};
+
+struct bench_buffer {
+    void *start;
+    size_t length;
+    int dmabuf;
+};
+
+struct bench_stats {
+    uint64_t frames;
+    uint64_t dropped;
+    uint64_t errors;
+    int64_t sensor_start;
+    int64_t sensor_frames;
+    double first_ts;
+    double last_ts;
+    double *latency;
+    size_t num_latency;
+    size_t max_latency;
+    double streamon_ms;
+    double first_frame_ms;
+    int64_t driver_us;
+};
+
+struct bench_stream {
+    const char *device;
+    const char *subdev;
+    int fd;
+    int subdev_fd;
+    int streaming;
+    int first_frame_pending;
+    int have_seq;
+    uint32_t last_seq;
+    double streamon_start;
+    double last_frame;
+
+    struct v4l2_format fmt;
+    struct bench_buffer buffers[BENCH_MAX_BUFFERS];
+    int buffer_count;
+
+    uint32_t frame_count_id;
+    uint32_t frame_rate_id;
+
+    struct bench_stats stats;
+};
+
+struct bench {
+    struct bench_stream streams[BENCH_MAX_STREAMS];
+    int num_streams;
+
+    struct bench_action actions[BENCH_MAX_ACTIONS];
+    int num_actions;
+
+    int seconds;
+    int num_buffers;
+    enum v4l2_memory memory;
+    FILE *csv;
+};
+
+static volatile sig_atomic_t stop;
+
+
+/***************************************************
+        Helpers
+****************************************************/
+
+/** xioctl - ioctl that retries on EINTR.
+ * @fd:      file descriptor.
+ * @request: ioctl request.
+ * @arg:     ioctl argument.
+ */
+static int xioctl(int fd, unsigned long request, void *arg)
+{
+    int ret;
+
+    do ret = ioctl(fd, request, arg);
+    while(ret == -1 && errno == EINTR);
+
+    return ret;
+}
+
+/** ctrl_find - looks up a control id by name.
+ * @fd:   video node.
+ * @name: control name, as reported by VIDIOC_QUERYCTRL.
+ *
+ * Custom DAX-C02 and Tegra controls are found by name so the tool does not
+ * need the kernel headers that define their ids.
+ */
+static uint32_t ctrl_find(int fd, const char *name)
+{
+    struct v4l2_queryctrl query;
+
+    memset(&query, 0, sizeof(query));
+    query.id = V4L2_CTRL_FLAG_NEXT_CTRL;
+
+    while(!xioctl(fd, VIDIOC_QUERYCTRL, &query))
+    {
+        if(!strcmp((const char *)query.name, name)) return query.id;
+        query.id |= V4L2_CTRL_FLAG_NEXT_CTRL;
+    }
+
+    return 0;
+}
+
+/** ctrl_set - sets an integer, menu or integer64 control.
+ * @fd:    video node.
+ * @id:    control id.
+ * @value: control value.
+ */
+static int ctrl_set(int fd, uint32_t id, int64_t value)
+{
+    struct v4l2_ext_controls ctrls;
+    struct v4l2_ext_control ctrl;
+    struct v4l2_queryctrl query;
+
+    memset(&query, 0, sizeof(query));
+    query.id = id;
+    if(xioctl(fd, VIDIOC_QUERYCTRL, &query)) return -1;
+
+    memset(&ctrls, 0, sizeof(ctrls));
+    memset(&ctrl, 0, sizeof(ctrl));
+
+    ctrl.id = id;
+    if(query.type == V4L2_CTRL_TYPE_INTEGER64) ctrl.value64 = value;
+    else ctrl.value = (int32_t)value;
+
+    ctrls.ctrl_class = V4L2_CTRL_ID2CLASS(id);
+    ctrls.count = 1;
+    ctrls.controls = &ctrl;
+
+    return xioctl(fd, VIDIOC_S_EXT_CTRLS, &ctrls);
+}
+
+/** ctrl_get64 - reads an integer64 control.
+ * @fd:    video node.
+ * @id:    control id.
+ * @value: control value.
+ */
+static int ctrl_get64(int fd, uint32_t id, int64_t *value)
+{
+    struct v4l2_ext_controls ctrls;
+    struct v4l2_ext_control ctrl;
+
+    memset(&ctrls, 0, sizeof(ctrls));
+    memset(&ctrl, 0, sizeof(ctrl));
+
+    ctrl.id = id;
+    ctrls.ctrl_class = V4L2_CTRL_ID2CLASS(id);
+    ctrls.count = 1;
+    ctrls.controls = &ctrl;
+
+    if(xioctl(fd, VIDIOC_G_EXT_CTRLS, &ctrls)) return -1;
+
+    *value = ctrl.value64;
+    return 0;
+}
+
+/** now_s - reads CLOCK_MONOTONIC, the clock V4L2 buffers are stamped with.
+ */
+static double now_s(void)
+{
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+/** timeval_s - converts a buffer timestamp to seconds.
+ * @tv: buffer timestamp.
+ */
+static double timeval_s(const struct timeval *tv)
+{
+    return tv->tv_sec + tv->tv_usec / 1e6;
+}
+
+static int compare_double(const void *a, const void *b)
+{
+    double x = *(const double *)a;
+    double y = *(const double *)b;
+
+    return (x > y) - (x < y);
+}
+
+static void on_signal(int sig)
+{
+    (void)sig;
+    stop = 1;
+}
+
+
+/***************************************************
+        Buffers
+****************************************************/
+
+/** buffers_free - unmaps and releases the capture buffers.
+ * @cb: pointer to the bench struct.
+ * @s:  stream.
+ *
+ * Exported buffers are released when their dmabuf is closed, after the
+ * queue lets go of them.
+ */
+static void buffers_free(struct bench *cb, struct bench_stream *s)
+{
+    struct v4l2_requestbuffers req;
+    int i;
+
+    for(i = 0; i < s->buffer_count; i++)
+    {
+        if(s->buffers[i].start) munmap(s->buffers[i].start, s->buffers[i].length);
+        s->buffers[i].start = NULL;
+    }
+
+    memset(&req, 0, sizeof(req));
+    req.type = V4L2_BUF_TYPE_VIDEO_CAPTURE;
+    req.memory = cb->memory;
+    xioctl(s->fd, VIDIOC_REQBUFS, &req);
+
+    for(i = 0; i < s->buffer_count; i++)
+    {
+        if(s->buffers[i].dmabuf >= 0) close(s->buffers[i].dmabuf);
+        s->buffers[i].dmabuf = -1;
+    }
+
+    s->buffer_count = 0;
+}
+
+/** buffers_alloc - allocates and queues the capture buffers.
+ * @cb: pointer to the bench struct.
+ * @s:  stream.
+ *
+ * In dmabuf mode the driver's own buffers are exported and the queue is
+ * switched to importing them, the same path a buffer shared with an
+ * encoder or GPU takes.  In mmap mode the buffers are mapped but never read.
+ */
+static int buffers_alloc(struct bench *cb, struct bench_stream *s)
+{
+    struct v4l2_requestbuffers req;
+    struct v4l2_exportbuffer exp;
+    struct v4l2_buffer buf;
+    int i;
+
+    memset(&req, 0, sizeof(req));
+    req.count = cb->num_buffers;
+    req.type = V4L2_BUF_TYPE_VIDEO_CAPTURE;
+    req.memory = V4L2_MEMORY_MMAP;
+
+    if(xioctl(s->fd, VIDIOC_REQBUFS, &req))
+    {
+        perror("VIDIOC_REQBUFS");
+        return -1;
+    }
+
+    for(i = 0; i < (int)req.count && i < BENCH_MAX_BUFFERS; i++)
+    {
+        memset(&buf, 0, sizeof(buf));
+        buf.type = V4L2_BUF_TYPE_VIDEO_CAPTURE;
+        buf.memory = V4L2_MEMORY_MMAP;
+        buf.index = i;
+
+        if(xioctl(s->fd, VIDIOC_QUERYBUF, &buf))
+        {
+            perror("VIDIOC_QUERYBUF");
+            return -1;
+        }
+
+        s->buffers[i].length = buf.length;
+        s->buffers[i].start = NULL;
+        s->buffers[i].dmabuf = -1;
+        s->buffer_count++;
+
+        if(cb->memory == V4L2_MEMORY_MMAP)
+        {
+            s->buffers[i].start = mmap(NULL, buf.length, PROT_READ | PROT_WRITE, MAP_SHARED, s->fd, buf.m.offset);
+            if(s->buffers[i].start == MAP_FAILED)
+            {
+                s->buffers[i].start = NULL;
+                perror("mmap");
+                return -1;
+            }
+            continue;
+        }
+
+        memset(&exp, 0, sizeof(exp));
+        exp.type = V4L2_BUF_TYPE_VIDEO_CAPTURE;
+        exp.index = i;
+        exp.flags = O_RDWR | O_CLOEXEC;
+
+        if(xioctl(s->fd, VIDIOC_EXPBUF, &exp))
+        {
+            perror("VIDIOC_EXPBUF");
+            return -1;
+        }
+        s->buffers[i].dmabuf = exp.fd;
+    }
+
+    if(cb->memory == V4L2_MEMORY_DMABUF)
+    {
+        /* the exported buffers outlive the mmap queue */
+        req.count = 0;
+        if(xioctl(s->fd, VIDIOC_REQBUFS, &req))
+        {
+            perror("VIDIOC_REQBUFS");
+            return -1;
+        }
+
+        req.count = s->buffer_count;
+        req.memory = V4L2_MEMORY_DMABUF;
+        if(xioctl(s->fd, VIDIOC_REQBUFS, &req))
+        {
+            perror("VIDIOC_REQBUFS dmabuf");
+            return -1;
+        }
+        if((int)req.count < s->buffer_count) s->buffer_count = req.count;
+    }
+
+    for(i = 0; i < s->buffer_count; i++)
+    {
+        memset(&buf, 0, sizeof(buf));
+        buf.type = V4L2_BUF_TYPE_VIDEO_CAPTURE;
+        buf.memory = cb->memory;
+        buf.index = i;
+
+        if(cb->memory == V4L2_MEMORY_DMABUF)
+        {
+            buf.m.fd = s->buffers[i].dmabuf;
+            buf.length = s->buffers[i].length;
+        }
+
+        if(xioctl(s->fd, VIDIOC_QBUF, &buf))
+        {
+            perror("VIDIOC_QBUF");
+            return -1;
+        }
+    }
+
+    return 0;
+}
+
+
+/***************************************************
+        Streams
+****************************************************/
+
+/** stream_open - opens a video node and its optional sensor subdev.
+ * @s: stream, with device and subdev set.
+ */
+static int stream_open(struct bench_stream *s)
+{
+    struct v4l2_event_subscription sub;
+
+    s->subdev_fd = -1;
+    s->fd = open(s->device, O_RDWR | O_NONBLOCK);
+    if(s->fd < 0)
+    {
+        perror(s->device);
+        return -1;
+    }
+
+    s->fmt.type = V4L2_BUF_TYPE_VIDEO_CAPTURE;
+    if(xioctl(s->fd, VIDIOC_G_FMT, &s->fmt))
+    {
+        perror("VIDIOC_G_FMT");
+        return -1;
+    }
+
+    /* optional, missing on nodes that are not a DAX-C02 */
+    s->frame_count_id = ctrl_find(s->fd, "Frame Count");
+    s->frame_rate_id = ctrl_find(s->fd, "Frame Rate");
+
+    if(!s->subdev) return 0;
+
+    s->subdev_fd = open(s->subdev, O_RDWR | O_NONBLOCK);
+    if(s->subdev_fd < 0)
+    {
+        perror(s->subdev);
+        return -1;
+    }
+
+    /* the driver reports its own share of the stream-on latency */
+    memset(&sub, 0, sizeof(sub));
+    sub.type = BENCH_EVENT_STREAM_STARTED;
+    if(xioctl(s->subdev_fd, VIDIOC_SUBSCRIBE_EVENT, &sub))
+    {
+        perror("VIDIOC_SUBSCRIBE_EVENT");
+        close(s->subdev_fd);
+        s->subdev_fd = -1;
+    }
+
+    return 0;
+}
+
+/** stream_start - queues buffers and starts streaming.
+ * @cb: pointer to the bench struct.
+ * @s:  stream.
+ */
+static int stream_start(struct bench *cb, struct bench_stream *s)
+{
+    enum v4l2_buf_type type = V4L2_BUF_TYPE_VIDEO_CAPTURE;
+
+    if(buffers_alloc(cb, s))
+    {
+        buffers_free(cb, s);
+        return -1;
+    }
+
+    s->streamon_start = now_s();
+    if(xioctl(s->fd, VIDIOC_STREAMON, &type))
+    {
+        perror("VIDIOC_STREAMON");
+        buffers_free(cb, s);
+        return -1;
+    }
+
+    s->stats.streamon_ms = (now_s() - s->streamon_start) * 1e3;
+    s->stats.first_frame_ms = -1;
+    s->first_frame_pending = 1;
+    s->have_seq = 0;
+    s->last_frame = s->streamon_start;
+    s->streaming = 1;
+    return 0;
+}
+
+/** stream_stop - stops streaming and releases the buffers.
+ * @cb: pointer to the bench struct.
+ * @s:  stream.
+ */
+static void stream_stop(struct bench *cb, struct bench_stream *s)
+{
+    enum v4l2_buf_type type = V4L2_BUF_TYPE_VIDEO_CAPTURE;
+
+    if(!s->streaming) return;
+
+    xioctl(s->fd, VIDIOC_STREAMOFF, &type);
+    buffers_free(cb, s);
+    s->streaming = 0;
+}
+
+/** stream_dequeue - accounts for one captured buffer and requeues it.
+ * @cb: pointer to the bench struct.
+ * @s:  stream.
+ */
+static int stream_dequeue(struct bench *cb, struct bench_stream *s)
+{
+    struct bench_stats *st = &s->stats;
+    struct v4l2_buffer buf;
+    double now, ts;
+    double *latency;
+
+    memset(&buf, 0, sizeof(buf));
+    buf.type = V4L2_BUF_TYPE_VIDEO_CAPTURE;
+    buf.memory = cb->memory;
+
+    if(xioctl(s->fd, VIDIOC_DQBUF, &buf))
+    {
+        if(errno == EAGAIN) return 0;
+        perror("VIDIOC_DQBUF");
+        return -1;
+    }
+
+    now = now_s();
+    ts = timeval_s(&buf.timestamp);
+    s->last_frame = now;
+
+    if(s->first_frame_pending)
+    {
+        st->first_frame_ms = (now - s->streamon_start) * 1e3;
+        s->first_frame_pending = 0;
+    }
+
+    if(s->have_seq && buf.sequence > s->last_seq + 1) st->dropped += buf.sequence - s->last_seq - 1;
+    s->last_seq = buf.sequence;
+    s->have_seq = 1;
+
+    if(!st->frames) st->first_ts = ts;
+    st->last_ts = ts;
+    st->frames++;
+    if(buf.flags & V4L2_BUF_FLAG_ERROR) st->errors++;
+
+    /* only comparable when the driver stamps with CLOCK_MONOTONIC */
+    if((buf.flags & V4L2_BUF_FLAG_TIMESTAMP_MASK) == V4L2_BUF_FLAG_TIMESTAMP_MONOTONIC)
+    {
+        if(st->num_latency == st->max_latency)
+        {
+            st->max_latency = st->max_latency ? st->max_latency * 2 : 1024;
+            latency = realloc(st->latency, st->max_latency * sizeof(double));
+            if(!latency) return -1;
+            st->latency = latency;
+        }
+        st->latency[st->num_latency++] = (now - ts) * 1e6;
+    }
+
+    if(cb->memory == V4L2_MEMORY_DMABUF)
+    {
+        buf.m.fd = s->buffers[buf.index].dmabuf;
+        buf.length = s->buffers[buf.index].length;
+    }
+
+    if(xioctl(s->fd, VIDIOC_QBUF, &buf))
+    {
+        perror("VIDIOC_QBUF");
+        return -1;
+    }
+
+    return 0;
+}
+
+/** stream_events - reads the driver's stream-on latency from the subdev.
+ * @s: stream.
+ */
+static void stream_events(struct bench_stream *s)
+{
+    struct bench_event_data data;
+    struct v4l2_event event;
+
+    while(!xioctl(s->subdev_fd, VIDIOC_DQEVENT, &event))
+    {
+        if(event.type != BENCH_EVENT_STREAM_STARTED) continue;
+
+        memcpy(&data, event.u.data, sizeof(data));
+        s->stats.driver_us = data.value;
+    }
+}
+
+
+/***************************************************
+        Actions
+****************************************************/
+
+/** action_parse - parses a [stream@]seconds:action argument.
+ * @a:   action to fill in.
+ * @arg: command line argument.
+ */
+static int action_parse(struct bench_action *a, const char *arg)
+{
+    const char *p = arg;
+    const char *eq;
+    char *end;
+    int n = 0;
+
+    memset(a, 0, sizeof(*a));
+    a->text = arg;
+    a->stream = -1;
+
+    if(sscanf(p, "%d@%n", &a->stream, &n) == 1 && n) p += n;
+    else a->stream = -1;
+
+    a->at = strtod(p, &end);
+    if(end == p || *end != ':' || a->at < 0) return -1;
+    p = end + 1;
+
+    if(!strcmp(p, "restart"))
+    {
+        a->type = BENCH_ACTION_RESTART;
+        return 0;
+    }
+
+    if(sscanf(p, "size=%ux%u", &a->width, &a->height) == 2)
+    {
+        a->type = BENCH_ACTION_SIZE;
+        return 0;
+    }
+
+    if(sscanf(p, "fps=%d", &a->fps) == 1 && a->fps > 0)
+    {
+        a->type = BENCH_ACTION_FPS;
+        return 0;
+    }
+
+    eq = strrchr(p, '=');
+    if(!eq || eq == p || eq - p >= (int)sizeof(a->name)) return -1;
+
+    memcpy(a->name, p, eq - p);
+    a->value = strtoll(eq + 1, &end, 0);
+    if(end == eq + 1 || *end) return -1;
+
+    a->type = BENCH_ACTION_CTRL;
+    return 0;
+}
+
+static int action_compare(const void *a, const void *b)
+{
+    return compare_double(&((const struct bench_action *)a)->at, &((const struct bench_action *)b)->at);
+}
+
+/** action_apply - runs one scheduled action on one stream.
+ * @cb: pointer to the bench struct.
+ * @s:  stream.
+ * @a:  action.
+ */
+static int action_apply(struct bench *cb, struct bench_stream *s, const struct bench_action *a)
+{
+    struct v4l2_streamparm parm;
+    uint32_t id;
+
+    switch(a->type)
+    {
+        case BENCH_ACTION_SIZE:
+            stream_stop(cb, s);
+            s->fmt.type = V4L2_BUF_TYPE_VIDEO_CAPTURE;
+            s->fmt.fmt.pix.width = a->width;
+            s->fmt.fmt.pix.height = a->height;
+            if(xioctl(s->fd, VIDIOC_S_FMT, &s->fmt)) perror("VIDIOC_S_FMT");
+            return stream_start(cb, s);
+
+        case BENCH_ACTION_RESTART:
+            stream_stop(cb, s);
+            return stream_start(cb, s);
+
+        case BENCH_ACTION_FPS:
+            if(s->frame_rate_id) return ctrl_set(s->fd, s->frame_rate_id, (int64_t)a->fps << BENCH_FPS_SHIFT);
+
+            memset(&parm, 0, sizeof(parm));
+            parm.type = V4L2_BUF_TYPE_VIDEO_CAPTURE;
+            parm.parm.capture.timeperframe.numerator = 1;
+            parm.parm.capture.timeperframe.denominator = a->fps;
+            return xioctl(s->fd, VIDIOC_S_PARM, &parm);
+
+        case BENCH_ACTION_CTRL:
+            id = ctrl_find(s->fd, a->name);
+            if(!id)
+            {
+                errno = ENOENT;
+                return -1;
+            }
+            return ctrl_set(s->fd, id, a->value);
+    }
+
+    return -1;
+}
+
+
+/***************************************************
+        Results
+****************************************************/
+
+/** stats_begin - starts a new phase for a stream.
+ * @s: stream.
+ *
+ * Stream-on figures only belong to the phase that restarted the stream.
+ */
+static void stats_begin(struct bench_stream *s)
+{
+    struct bench_stats *st = &s->stats;
+    double *latency = st->latency;
+    size_t max_latency = st->max_latency;
+
+    memset(st, 0, sizeof(*st));
+    st->latency = latency;
+    st->max_latency = max_latency;
+    st->streamon_ms = -1;
+    st->first_frame_ms = -1;
+    st->driver_us = -1;
+}
+
+/** stats_sensor - reads the sensor frame counter at a phase boundary.
+ * @s:     stream.
+ * @start: true at the start of the phase.
+ */
+static void stats_sensor(struct bench_stream *s, int start)
+{
+    int64_t count;
+
+    if(!s->frame_count_id || !s->streaming || ctrl_get64(s->fd, s->frame_count_id, &count)) return;
+
+    if(start) s->stats.sensor_start = count;
+    else if(s->stats.sensor_start) s->stats.sensor_frames = count - s->stats.sensor_start;
+}
+
+/** stats_report - prints and logs the results of one phase.
+ * @cb:    pointer to the bench struct.
+ * @phase: phase number.
+ * @start: phase start in seconds from the start of the run.
+ * @end:   phase end in seconds from the start of the run.
+ */
+static void stats_report(struct bench *cb, int phase, double start, double end)
+{
+    struct bench_stream *s;
+    struct bench_stats *st;
+    double pct[5] = { 0 };
+    double span, fps;
+    int i;
+
+    printf("phase %d, %.1f-%.1f s\n", phase, start, end);
+
+    for(i = 0; i < cb->num_streams; i++)
+    {
+        s = &cb->streams[i];
+        st = &s->stats;
+        stats_sensor(s, 0);
+
+        span = st->last_ts - st->first_ts;
+        fps = st->frames > 1 && span > 0 ? (st->frames - 1) / span : 0;
+
+        printf("  %s %ux%u\n", s->device, s->fmt.fmt.pix.width, s->fmt.fmt.pix.height);
+        printf("    frames     %llu, %.2f fps, %llu dropped, %llu errors", (unsigned long long)st->frames,
+            fps, (unsigned long long)st->dropped, (unsigned long long)st->errors);
+        if(st->sensor_frames)
+            printf(", sensor sent %lld", (long long)st->sensor_frames);
+        printf("\n");
+
+        if(st->streamon_ms >= 0)
+        {
+            printf("    stream on  ioctl %.1f ms, first frame %.1f ms", st->streamon_ms, st->first_frame_ms);
+            if(st->driver_us >= 0) printf(", driver %lld us", (long long)st->driver_us);
+            printf("\n");
+        }
+
+        if(st->num_latency)
+        {
+            qsort(st->latency, st->num_latency, sizeof(double), compare_double);
+            pct[0] = st->latency[0];
+            pct[1] = st->latency[(st->num_latency - 1) / 2];
+            pct[2] = st->latency[(st->num_latency - 1) * 90 / 100];
+            pct[3] = st->latency[(st->num_latency - 1) * 99 / 100];
+            pct[4] = st->latency[st->num_latency - 1];
+
+            printf("    latency    min %.0f us, p50 %.0f us, p90 %.0f us, p99 %.0f us, max %.0f us\n",
+                pct[0], pct[1], pct[2], pct[3], pct[4]);
+        }
+        else if(st->frames) printf("    latency    n/a, buffer timestamps are not CLOCK_MONOTONIC\n");
+
+        if(cb->csv)
+        {
+            fprintf(cb->csv, "%d,%.3f,%.3f,%s,%u,%u,%llu,%.3f,%llu,%llu,%lld,%.3f,%.3f,%lld,%.1f,%.1f,%.1f,%.1f,%.1f\n",
+                phase, start, end, s->device, s->fmt.fmt.pix.width, s->fmt.fmt.pix.height,
+                (unsigned long long)st->frames, fps, (unsigned long long)st->dropped, (unsigned long long)st->errors,
+                (long long)st->sensor_frames, st->streamon_ms, st->first_frame_ms, (long long)st->driver_us,
+                pct[0], pct[1], pct[2], pct[3], pct[4]);
+            fflush(cb->csv);
+        }
+    }
+}
+
+
+/***************************************************
+        Run
+****************************************************/
+
+/** bench_run - streams every node and runs the action schedule.
+ * @cb: pointer to the bench struct.
+ */
+static int bench_run(struct bench *cb)
+{
+    struct bench_stream *s;
+    struct bench_action *a;
+    struct timeval timeout;
+    fd_set rfds, efds;
+    double start, elapsed, phase_start = 0;
+    int next = 0, phase = 0;
+    int failed = 0;
+    int max_fd;
+    int ret;
+    int i;
+
+    qsort(cb->actions, cb->num_actions, sizeof(cb->actions[0]), action_compare);
+
+    start = now_s();
+    for(i = 0; i < cb->num_streams; i++)
+    {
+        stats_begin(&cb->streams[i]);
+        if(stream_start(cb, &cb->streams[i])) return -1;
+        stats_sensor(&cb->streams[i], 1);
+    }
+
+    while(!stop && !failed)
+    {
+        elapsed = now_s() - start;
+        if(elapsed >= cb->seconds) break;
+
+        if(next < cb->num_actions && elapsed >= cb->actions[next].at)
+        {
+            stats_report(cb, phase++, phase_start, elapsed);
+            phase_start = elapsed;
+
+            for(i = 0; i < cb->num_streams; i++) stats_begin(&cb->streams[i]);
+
+            for(; next < cb->num_actions && cb->actions[next].at <= elapsed; next++)
+            {
+                a = &cb->actions[next];
+                for(i = 0; i < cb->num_streams; i++)
+                {
+                    s = &cb->streams[i];
+                    if(a->stream >= 0 && a->stream != i) continue;
+
+                    printf("%.1f s: %s %s\n", elapsed, s->device, a->text);
+                    if(action_apply(cb, s, a))
+                    {
+                        fprintf(stderr, "%s: %s failed: %s\n", s->device, a->text, strerror(errno));
+                        if(!s->streaming) failed = 1;
+                    }
+                }
+            }
+
+            for(i = 0; i < cb->num_streams; i++) stats_sensor(&cb->streams[i], 1);
+            continue;
+        }
+
+        FD_ZERO(&rfds);
+        FD_ZERO(&efds);
+        max_fd = 0;
+
+        for(i = 0; i < cb->num_streams; i++)
+        {
+            s = &cb->streams[i];
+            FD_SET(s->fd, &rfds);
+            if(s->fd > max_fd) max_fd = s->fd;
+
+            if(s->subdev_fd >= 0)
+            {
+                FD_SET(s->subdev_fd, &efds);
+                if(s->subdev_fd > max_fd) max_fd = s->subdev_fd;
+            }
+        }
+
+        /* short enough for actions to fire on time */
+        timeout.tv_sec = 0;
+        timeout.tv_usec = BENCH_POLL_US;
+
+        ret = select(max_fd + 1, &rfds, NULL, &efds, &timeout);
+        if(ret < 0)
+        {
+            if(errno == EINTR) continue;
+            perror("select");
+            failed = 1;
+            break;
+        }
+
+        for(i = 0; i < cb->num_streams; i++)
+        {
+            s = &cb->streams[i];
+
+            if(s->subdev_fd >= 0 && FD_ISSET(s->subdev_fd, &efds)) stream_events(s);
+            if(FD_ISSET(s->fd, &rfds) && stream_dequeue(cb, s)) failed = 1;
+
+            if(now_s() - s->last_frame > BENCH_TIMEOUT_S)
+            {
+                fprintf(stderr, "%s: timed out waiting for a frame\n", s->device);
+                failed = 1;
+            }
+        }
+    }
+
+    stats_report(cb, phase, phase_start, now_s() - start);
+
+    for(i = 0; i < cb->num_streams; i++)
+    {
+        stream_stop(cb, &cb->streams[i]);
+        free(cb->streams[i].stats.latency);
+    }
+
+    return failed ? -1 : 0;
+}
+
+
+/***************************************************
+        Setup
+****************************************************/
+
+static void usage(const char *name)
+{
+    fprintf(stderr,
+        "usage: %s [-d video[:subdev]]... [-t seconds] [-n buffers] [-m mmap|dmabuf]\n"
+        "          [-a [stream@]seconds:action]... [-c results.csv]\n"
+        "  -d  video node to stream, repeatable, default /dev/video0 and /dev/video1\n"
+        "      with the sensor subdev node, the driver's stream-on latency is reported\n"
+        "  -t  run time in seconds, default 10\n"
+        "  -n  number of buffers per stream, default 4\n"
+        "  -m  buffer memory, mmap or dmabuf, default dmabuf\n"
+        "  -a  action at a time, on every stream or the stream index given:\n"
+        "        size=WxH, fps=N, restart, or NAME=VALUE to set a control\n"
+        "  -c  append one CSV row per stream and phase to a file\n",
+        name);
+}
+
+int main(int argc, char **argv)
+{
+    struct bench cb;
+    struct bench_stream *s;
+    char *subdev;
+    int ret;
+    int opt;
+    int i;
+
+    memset(&cb, 0, sizeof(cb));
+    cb.seconds = 10;
+    cb.num_buffers = 4;
+    cb.memory = V4L2_MEMORY_DMABUF;
+
+    while((opt = getopt(argc, argv, "d:t:n:m:a:c:h")) != -1)
+    {
+        switch(opt)
+        {
+            case 'd':
+                if(cb.num_streams == BENCH_MAX_STREAMS)
+                {
+                    usage(argv[0]);
+                    return 1;
+                }
+                s = &cb.streams[cb.num_streams++];
+                s->device = optarg;
+                subdev = strchr(optarg, ':');
+                if(subdev)
+                {
+                    *subdev = '\0';
+                    s->subdev = subdev + 1;
+                }
+                break;
+            case 't':
+                cb.seconds = atoi(optarg);
+                break;
+            case 'n':
+                cb.num_buffers = atoi(optarg);
+                break;
+            case 'm':
+                if(!strcmp(optarg, "mmap")) cb.memory = V4L2_MEMORY_MMAP;
+                else if(!strcmp(optarg, "dmabuf")) cb.memory = V4L2_MEMORY_DMABUF;
+                else
+                {
+                    usage(argv[0]);
+                    return 1;
+                }
+                break;
+            case 'a':
+                if(cb.num_actions == BENCH_MAX_ACTIONS || action_parse(&cb.actions[cb.num_actions], optarg))
+                {
+                    fprintf(stderr, "bad action '%s'\n", optarg);
+                    usage(argv[0]);
+                    return 1;
+                }
+                cb.num_actions++;
+                break;
+            case 'c':
+                cb.csv = fopen(optarg, "a");
+                if(!cb.csv)
+                {
+                    perror(optarg);
+                    return 1;
+                }
+                fseek(cb.csv, 0, SEEK_END);
+                if(!ftell(cb.csv))
+                    fprintf(cb.csv, "phase,start_s,end_s,device,width,height,frames,fps,dropped,errors,sensor_frames,"
+                        "streamon_ms,first_frame_ms,driver_us,latency_min_us,latency_p50_us,latency_p90_us,"
+                        "latency_p99_us,latency_max_us\n");
+                break;
+            default:
+                usage(argv[0]);
+                return 1;
+        }
+    }
+
+    if(!cb.num_streams)
+    {
+        cb.streams[0].device = "/dev/video0";
+        cb.streams[1].device = "/dev/video1";
+        cb.num_streams = 2;
+    }
+
+    for(i = 0; i < cb.num_actions; i++)
+    {
+        if(cb.actions[i].stream >= cb.num_streams)
+        {
+            fprintf(stderr, "bad action '%s', no stream %d\n", cb.actions[i].text, cb.actions[i].stream);
+            return 1;
+        }
+    }
+
+    if(cb.seconds <= 0 || cb.num_buffers < 2 || cb.num_buffers > BENCH_MAX_BUFFERS)
+    {
+        usage(argv[0]);
+        return 1;
+    }
+
+    for(i = 0; i < cb.num_streams; i++)
+    {
+        if(stream_open(&cb.streams[i])) return 1;
+    }
+
+    signal(SIGINT, on_signal);
+    signal(SIGTERM, on_signal);
+
+    ret = bench_run(&cb);
+
+    for(i = 0; i < cb.num_streams; i++)
+    {
+        close(cb.streams[i].fd);
+        if(cb.streams[i].subdev_fd >= 0) close(cb.streams[i].subdev_fd);
+    }
+
+    if(cb.csv) fclose(cb.csv);
+    return ret ? 1 : 0;
+}
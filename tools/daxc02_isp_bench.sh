@@ -0,0 +1,85 @@
+#!/bin/sh
+#
+# Compares ISP override profiles by streaming frames through nvcamerasrc and
+# timing them from their buffer timestamps after a warm-up, so pipeline and
+# daemon startup are not counted.  The sensor caps throughput at its own frame
+# rate, so a profile the ISP keeps up with reports the sensor rate; a heavier
+# profile shows up as dropped frames, a lower rate and more interval jitter.
+#
+# Usage: daxc02_isp_bench.sh [-i SENSOR_ID] [-s WIDTHxHEIGHT] [-r FPS] [-n FRAMES] [-w WARMUP] PROFILE...
+#
+# Copyright 2017-2018 Nova Dynamics LLC
+#
+# This program is free software; you can redistribute it and/or modify
+# it under the terms of the version 2 of the GNU General Public License
+# as published by the Free Software Foundation
+
+SENSOR_ID=0
+SIZE=1280x580
+FPS=60
+FRAMES=600
+WARMUP=60
+SETTINGS_DIR=/var/nvidia/nvcam/settings
+DAEMON=nvcamera-daemon
+
+while getopts "i:s:r:n:w:h" opt; do
+    case $opt in
+        i) SENSOR_ID=$OPTARG ;;
+        s) SIZE=$OPTARG ;;
+        r) FPS=$OPTARG ;;
+        n) FRAMES=$OPTARG ;;
+        w) WARMUP=$OPTARG ;;
+        *) sed -n '9p' "$0"; exit 1 ;;
+    esac
+done
+shift $((OPTIND - 1))
+
+if [ $# -eq 0 ]; then
+    sed -n '9p' "$0"
+    exit 1
+fi
+
+BACKUP=$(mktemp)
+LOG=$(mktemp)
+cp "$SETTINGS_DIR/camera_overrides.isp" "$BACKUP" 2>/dev/null
+
+# put the installed profile back however the run ends
+restore() {
+    if [ -s "$BACKUP" ]; then
+        cp "$BACKUP" "$SETTINGS_DIR/camera_overrides.isp"
+        systemctl restart $DAEMON
+    fi
+    rm -f "$BACKUP" "$LOG"
+}
+trap restore EXIT
+trap 'exit 1' INT TERM
+
+printf "%-32s %8s %10s %8s %12s\n" profile frames fps dropped "jitter us"
+for PROFILE in "$@"; do
+    cp "$PROFILE" "$SETTINGS_DIR/camera_overrides.isp" || exit 1
+    systemctl restart $DAEMON
+    sleep 2
+
+    # fakesink prints the timestamp of every buffer it receives
+    gst-launch-1.0 -v nvcamerasrc sensor-id=$SENSOR_ID num-buffers=$((WARMUP + FRAMES)) \
+        ! "video/x-raw(memory:NVMM),width=${SIZE%x*},height=${SIZE#*x},framerate=$FPS/1" \
+        ! fakesink sync=false silent=false > "$LOG" || exit 1
+
+    sed -n 's/.*last-message = chain.* pts: \([0-9]*\):\([0-9]*\):\([0-9.]*\),.*/\1 \2 \3/p' "$LOG" |
+        awk -v warmup=$WARMUP -v fps=$FPS -v name="$(basename "$PROFILE")" '
+            { t = $1 * 3600 + $2 * 60 + $3 }
+            NR <= warmup { next }
+            n > 0 {
+                dt = t - last
+                sum += dt; sumsq += dt * dt
+                if(dt > 1.5 / fps) dropped += int(dt * fps + 0.5) - 1
+            }
+            { if(n == 0) first = t; last = t; n++ }
+            END {
+                if(n < 2) { printf "%-32s %8d %10s\n", name, n, "n/a"; exit 1 }
+                mean = sum / (n - 1)
+                var = sumsq / (n - 1) - mean * mean
+                printf "%-32s %8d %10.2f %8d %12.0f\n", name, n, (n - 1) / (last - first),
+                    dropped, sqrt(var > 0 ? var : 0) * 1e6
+            }' || exit 1
+done
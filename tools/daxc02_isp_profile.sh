@@ -0,0 +1,48 @@
+#!/bin/sh
+#
+# Installs the ISP override profile the DAX-C02 driver recommends for the
+# active mode and restarts the camera daemon if the profile changed.
+#
+# Usage: daxc02_isp_profile.sh [-d /dev/videoN] [-s WIDTHxHEIGHT] [-p PROFILE_DIR]
+#
+# Copyright 2017-2018 Nova Dynamics LLC
+#
+# This program is free software; you can redistribute it and/or modify
+# it under the terms of the version 2 of the GNU General Public License
+# as published by the Free Software Foundation
+
+DEVICE=/dev/video0
+SIZE=
+PROFILE_DIR=$(dirname "$0")/..
+SETTINGS_DIR=/var/nvidia/nvcam/settings
+DAEMON=nvcamera-daemon
+
+while getopts "d:s:p:h" opt; do
+    case $opt in
+        d) DEVICE=$OPTARG ;;
+        s) SIZE=$OPTARG ;;
+        p) PROFILE_DIR=$OPTARG ;;
+        *) sed -n '6p' "$0"; exit 1 ;;
+    esac
+done
+
+if [ -n "$SIZE" ]; then
+    v4l2-ctl -d "$DEVICE" --set-fmt-video=width=${SIZE%x*},height=${SIZE#*x} || exit 1
+fi
+
+PROFILE=$(v4l2-ctl -d "$DEVICE" --get-ctrl=isp_profile | sed -n 's/^isp_profile: *//p')
+if [ -z "$PROFILE" ] || [ ! -f "$PROFILE_DIR/$PROFILE" ]; then
+    echo "no ISP profile '$PROFILE' in $PROFILE_DIR" >&2
+    exit 1
+fi
+
+if cmp -s "$PROFILE_DIR/$PROFILE" "$SETTINGS_DIR/camera_overrides.isp"; then
+    echo "$PROFILE already active"
+    exit 0
+fi
+
+mkdir -p "$SETTINGS_DIR"
+cp "$PROFILE_DIR/$PROFILE" "$SETTINGS_DIR/camera_overrides.isp" || exit 1
+chmod 664 "$SETTINGS_DIR/camera_overrides.isp"
+systemctl restart $DAEMON
+echo "installed $PROFILE"
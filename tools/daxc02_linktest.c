@@ -0,0 +1,673 @@
+/*
+ * daxc02_linktest.c - CSI link throughput and integrity test for the DAX-C02.
+ *
+ * Streams a sensor test pattern through the MT9M021, TC358746 and the Tegra
+ * CSI/VI and checks every captured frame against the pattern.  Sensor test
+ * patterns are static, so the reference is the bitwise majority of the
+ * first three frames and any later difference is a link error.
+ *
+ * Build on the target:
+ *     gcc -O2 -Wall -o daxc02_linktest daxc02_linktest.c -lm
+ *
+ * Usage:
+ *     daxc02_linktest [-d /dev/video0] [-p pattern] [-t seconds] [-r fps]
+ *                     [-s WxH]... [-n buffers] [-v]
+ *
+ * Without -s every frame size the node enumerates is tested in turn.
+ */
+
+#include <errno.h>
+#include <fcntl.h>
+#include <getopt.h>
+#include <math.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+
+#include <sys/ioctl.h>
+#include <sys/mman.h>
+#include <sys/select.h>
+
+#include <linux/videodev2.h>
+
+#define LINKTEST_MAX_BUFFERS        16
+#define LINKTEST_MAX_SIZES          16
+#define LINKTEST_REF_FRAMES         3
+#define LINKTEST_TIMEOUT_S          2
+
+/* Walking 1s, the only pattern that toggles every bit */
+#define LINKTEST_DEF_PATTERN        4
+
+/* TEGRA_CAMERA_CID_FRAME_RATE is Q42.22 */
+#define LINKTEST_FPS_SHIFT          22
+
+struct linktest_buffer {
+    void *start;
+    size_t length;
+};
+
+struct linktest_size {
+    uint32_t width;
+    uint32_t height;
+};
+
+struct linktest_result {
+    uint64_t frames;
+    uint64_t dropped;
+    uint64_t bad_frames;
+    uint64_t bit_errors;
+    uint64_t bits_checked;
+    int64_t sensor_frames;
+    double first_ts;
+    double last_ts;
+    double interval_sum;
+    double interval_sq_sum;
+    double interval_min;
+    double interval_max;
+};
+
+struct linktest {
+    const char *device;
+    int fd;
+    int pattern;
+    int seconds;
+    int fps;
+    int num_buffers;
+    int verbose;
+
+    struct linktest_size sizes[LINKTEST_MAX_SIZES];
+    int num_sizes;
+
+    struct linktest_buffer buffers[LINKTEST_MAX_BUFFERS];
+    int buffer_count;
+
+    struct v4l2_format fmt;
+    uint16_t *ref;
+    uint16_t *votes[LINKTEST_REF_FRAMES];
+    size_t samples;
+};
+
+
+/***************************************************
+        Helpers
+****************************************************/
+
+/** xioctl - ioctl that retries on EINTR.
+ * @fd:      file descriptor.
+ * @request: ioctl request.
+ * @arg:     ioctl argument.
+ */
+static int xioctl(int fd, unsigned long request, void *arg)
+{
+    int ret;
+
+    do ret = ioctl(fd, request, arg);
+    while(ret == -1 && errno == EINTR);
+
+    return ret;
+}
+
+/** ctrl_find - looks up a control id by name.
+ * @lt:   pointer to the linktest struct.
+ * @name: control name, as reported by VIDIOC_QUERYCTRL.
+ *
+ * Custom DAX-C02 and Tegra controls are found by name so the tool does not
+ * need the kernel headers that define their ids.
+ */
+static uint32_t ctrl_find(struct linktest *lt, const char *name)
+{
+    struct v4l2_queryctrl query;
+
+    memset(&query, 0, sizeof(query));
+    query.id = V4L2_CTRL_FLAG_NEXT_CTRL;
+
+    while(!xioctl(lt->fd, VIDIOC_QUERYCTRL, &query))
+    {
+        if(!strcmp((const char *)query.name, name)) return query.id;
+        query.id |= V4L2_CTRL_FLAG_NEXT_CTRL;
+    }
+
+    return 0;
+}
+
+/** ctrl_set - sets an integer, menu or integer64 control.
+ * @lt:    pointer to the linktest struct.
+ * @id:    control id.
+ * @value: control value.
+ */
+static int ctrl_set(struct linktest *lt, uint32_t id, int64_t value)
+{
+    struct v4l2_ext_controls ctrls;
+    struct v4l2_ext_control ctrl;
+    struct v4l2_queryctrl query;
+
+    memset(&query, 0, sizeof(query));
+    query.id = id;
+    if(xioctl(lt->fd, VIDIOC_QUERYCTRL, &query)) return -1;
+
+    memset(&ctrls, 0, sizeof(ctrls));
+    memset(&ctrl, 0, sizeof(ctrl));
+
+    ctrl.id = id;
+    if(query.type == V4L2_CTRL_TYPE_INTEGER64) ctrl.value64 = value;
+    else ctrl.value = (int32_t)value;
+
+    ctrls.ctrl_class = V4L2_CTRL_ID2CLASS(id);
+    ctrls.count = 1;
+    ctrls.controls = &ctrl;
+
+    return xioctl(lt->fd, VIDIOC_S_EXT_CTRLS, &ctrls);
+}
+
+/** ctrl_get64 - reads an integer64 control.
+ * @lt:    pointer to the linktest struct.
+ * @id:    control id.
+ * @value: control value.
+ */
+static int ctrl_get64(struct linktest *lt, uint32_t id, int64_t *value)
+{
+    struct v4l2_ext_controls ctrls;
+    struct v4l2_ext_control ctrl;
+
+    memset(&ctrls, 0, sizeof(ctrls));
+    memset(&ctrl, 0, sizeof(ctrl));
+
+    ctrl.id = id;
+    ctrls.ctrl_class = V4L2_CTRL_ID2CLASS(id);
+    ctrls.count = 1;
+    ctrls.controls = &ctrl;
+
+    if(xioctl(lt->fd, VIDIOC_G_EXT_CTRLS, &ctrls)) return -1;
+
+    *value = ctrl.value64;
+    return 0;
+}
+
+/** timeval_s - converts a buffer timestamp to seconds.
+ * @tv: buffer timestamp.
+ */
+static double timeval_s(const struct timeval *tv)
+{
+    return tv->tv_sec + tv->tv_usec / 1e6;
+}
+
+
+/***************************************************
+        Buffers
+****************************************************/
+
+/** buffers_free - unmaps and releases the capture buffers.
+ * @lt: pointer to the linktest struct.
+ */
+static void buffers_free(struct linktest *lt)
+{
+    struct v4l2_requestbuffers req;
+    int i;
+
+    for(i = 0; i < lt->buffer_count; i++)
+        munmap(lt->buffers[i].start, lt->buffers[i].length);
+
+    lt->buffer_count = 0;
+
+    memset(&req, 0, sizeof(req));
+    req.type = V4L2_BUF_TYPE_VIDEO_CAPTURE;
+    req.memory = V4L2_MEMORY_MMAP;
+    xioctl(lt->fd, VIDIOC_REQBUFS, &req);
+
+    free(lt->ref);
+    lt->ref = NULL;
+    for(i = 0; i < LINKTEST_REF_FRAMES; i++)
+    {
+        free(lt->votes[i]);
+        lt->votes[i] = NULL;
+    }
+}
+
+/** buffers_alloc - requests, maps and queues the capture buffers.
+ * @lt: pointer to the linktest struct.
+ */
+static int buffers_alloc(struct linktest *lt)
+{
+    struct v4l2_requestbuffers req;
+    struct v4l2_buffer buf;
+    int i;
+
+    memset(&req, 0, sizeof(req));
+    req.count = lt->num_buffers;
+    req.type = V4L2_BUF_TYPE_VIDEO_CAPTURE;
+    req.memory = V4L2_MEMORY_MMAP;
+
+    if(xioctl(lt->fd, VIDIOC_REQBUFS, &req))
+    {
+        perror("VIDIOC_REQBUFS");
+        return -1;
+    }
+
+    for(i = 0; i < (int)req.count && i < LINKTEST_MAX_BUFFERS; i++)
+    {
+        memset(&buf, 0, sizeof(buf));
+        buf.type = V4L2_BUF_TYPE_VIDEO_CAPTURE;
+        buf.memory = V4L2_MEMORY_MMAP;
+        buf.index = i;
+
+        if(xioctl(lt->fd, VIDIOC_QUERYBUF, &buf))
+        {
+            perror("VIDIOC_QUERYBUF");
+            return -1;
+        }
+
+        lt->buffers[i].length = buf.length;
+        lt->buffers[i].start = mmap(NULL, buf.length, PROT_READ | PROT_WRITE, MAP_SHARED, lt->fd, buf.m.offset);
+        if(lt->buffers[i].start == MAP_FAILED)
+        {
+            perror("mmap");
+            return -1;
+        }
+        lt->buffer_count++;
+
+        if(xioctl(lt->fd, VIDIOC_QBUF, &buf))
+        {
+            perror("VIDIOC_QBUF");
+            return -1;
+        }
+    }
+
+    /* RAW12 arrives in 16-bit containers */
+    lt->samples = (size_t)lt->fmt.fmt.pix.bytesperline / 2 * lt->fmt.fmt.pix.height;
+    lt->ref = calloc(lt->samples, sizeof(uint16_t));
+    if(!lt->ref) return -1;
+
+    for(i = 0; i < LINKTEST_REF_FRAMES; i++)
+    {
+        lt->votes[i] = calloc(lt->samples, sizeof(uint16_t));
+        if(!lt->votes[i]) return -1;
+    }
+
+    return 0;
+}
+
+
+/***************************************************
+        Frame Checking
+****************************************************/
+
+/** frame_check - compares a frame against the reference.
+ * @lt:    pointer to the linktest struct.
+ * @frame: captured frame.
+ * @res:   results to update.
+ *
+ * The first frames vote on the reference, and are checked against it once
+ * it is complete.
+ */
+static void frame_check(struct linktest *lt, const uint16_t *frame, struct linktest_result *res)
+{
+    uint64_t errors = 0;
+    uint64_t frame_index = res->frames;
+    uint16_t a, b, c;
+    size_t i;
+    int j;
+
+    if(frame_index < LINKTEST_REF_FRAMES)
+    {
+        memcpy(lt->votes[frame_index], frame, lt->samples * sizeof(uint16_t));
+        if(frame_index < LINKTEST_REF_FRAMES - 1) return;
+
+        for(i = 0; i < lt->samples; i++)
+        {
+            a = lt->votes[0][i];
+            b = lt->votes[1][i];
+            c = lt->votes[2][i];
+            lt->ref[i] = (a & b) | (a & c) | (b & c);
+        }
+
+        for(j = 0; j < LINKTEST_REF_FRAMES; j++)
+        {
+            errors = 0;
+            for(i = 0; i < lt->samples; i++)
+                errors += __builtin_popcount(lt->votes[j][i] ^ lt->ref[i]);
+
+            res->bit_errors += errors;
+            res->bits_checked += lt->samples * 16;
+            if(errors) res->bad_frames++;
+        }
+        return;
+    }
+
+    for(i = 0; i < lt->samples; i++)
+        errors += __builtin_popcount(frame[i] ^ lt->ref[i]);
+
+    res->bit_errors += errors;
+    res->bits_checked += lt->samples * 16;
+
+    if(errors)
+    {
+        res->bad_frames++;
+        if(lt->verbose) fprintf(stderr, "frame %llu: %llu bit errors\n",
+            (unsigned long long)frame_index, (unsigned long long)errors);
+    }
+}
+
+
+/***************************************************
+        Test Run
+****************************************************/
+
+/** linktest_run - streams one frame size and collects results.
+ * @lt:   pointer to the linktest struct.
+ * @size: frame size to test.
+ * @res:  results.
+ */
+static int linktest_run(struct linktest *lt, const struct linktest_size *size, struct linktest_result *res)
+{
+    enum v4l2_buf_type type = V4L2_BUF_TYPE_VIDEO_CAPTURE;
+    struct v4l2_buffer buf;
+    struct timeval timeout;
+    struct timespec start, now;
+    uint32_t frame_count_id;
+    uint32_t last_seq = 0;
+    int64_t sensor_start = 0, sensor_end = 0;
+    double ts, interval;
+    fd_set fds;
+    int ret = -1;
+
+    memset(res, 0, sizeof(*res));
+    res->interval_min = 1e9;
+
+    lt->fmt.type = V4L2_BUF_TYPE_VIDEO_CAPTURE;
+    if(xioctl(lt->fd, VIDIOC_G_FMT, &lt->fmt))
+    {
+        perror("VIDIOC_G_FMT");
+        return -1;
+    }
+
+    lt->fmt.fmt.pix.width = size->width;
+    lt->fmt.fmt.pix.height = size->height;
+    if(xioctl(lt->fd, VIDIOC_S_FMT, &lt->fmt))
+    {
+        perror("VIDIOC_S_FMT");
+        return -1;
+    }
+
+    if(ctrl_set(lt, V4L2_CID_TEST_PATTERN, lt->pattern))
+        fprintf(stderr, "warning: unable to set test pattern %d\n", lt->pattern);
+
+    if(lt->fps && ctrl_find(lt, "Frame Rate"))
+    {
+        if(ctrl_set(lt, ctrl_find(lt, "Frame Rate"), (int64_t)lt->fps << LINKTEST_FPS_SHIFT))
+            fprintf(stderr, "warning: unable to set frame rate %d\n", lt->fps);
+    }
+
+    if(buffers_alloc(lt)) goto out;
+
+    /* the sensor frame counter tells link drops from sensor stalls */
+    frame_count_id = ctrl_find(lt, "Frame Count");
+
+    if(xioctl(lt->fd, VIDIOC_STREAMON, &type))
+    {
+        perror("VIDIOC_STREAMON");
+        goto out;
+    }
+
+    if(frame_count_id) ctrl_get64(lt, frame_count_id, &sensor_start);
+
+    clock_gettime(CLOCK_MONOTONIC, &start);
+
+    for(;;)
+    {
+        clock_gettime(CLOCK_MONOTONIC, &now);
+        if(now.tv_sec - start.tv_sec >= lt->seconds) break;
+
+        FD_ZERO(&fds);
+        FD_SET(lt->fd, &fds);
+        timeout.tv_sec = LINKTEST_TIMEOUT_S;
+        timeout.tv_usec = 0;
+
+        ret = select(lt->fd + 1, &fds, NULL, NULL, &timeout);
+        if(ret < 0 && errno == EINTR) continue;
+        if(ret <= 0)
+        {
+            fprintf(stderr, "%s\n", ret ? "select failed" : "timed out waiting for a frame");
+            ret = -1;
+            break;
+        }
+
+        memset(&buf, 0, sizeof(buf));
+        buf.type = V4L2_BUF_TYPE_VIDEO_CAPTURE;
+        buf.memory = V4L2_MEMORY_MMAP;
+
+        if(xioctl(lt->fd, VIDIOC_DQBUF, &buf))
+        {
+            if(errno == EAGAIN) continue;
+            perror("VIDIOC_DQBUF");
+            ret = -1;
+            break;
+        }
+
+        ts = timeval_s(&buf.timestamp);
+        if(res->frames)
+        {
+            if(buf.sequence > last_seq + 1) res->dropped += buf.sequence - last_seq - 1;
+
+            interval = ts - res->last_ts;
+            res->interval_sum += interval;
+            res->interval_sq_sum += interval * interval;
+            if(interval < res->interval_min) res->interval_min = interval;
+            if(interval > res->interval_max) res->interval_max = interval;
+        }
+        else res->first_ts = ts;
+
+        res->last_ts = ts;
+        last_seq = buf.sequence;
+
+        /* errored buffers carry partial frames */
+        if(buf.flags & V4L2_BUF_FLAG_ERROR) res->bad_frames++;
+        else frame_check(lt, lt->buffers[buf.index].start, res);
+
+        res->frames++;
+
+        if(xioctl(lt->fd, VIDIOC_QBUF, &buf))
+        {
+            perror("VIDIOC_QBUF");
+            ret = -1;
+            break;
+        }
+
+        ret = 0;
+    }
+
+    if(frame_count_id && !ctrl_get64(lt, frame_count_id, &sensor_end))
+        res->sensor_frames = sensor_end - sensor_start;
+
+    xioctl(lt->fd, VIDIOC_STREAMOFF, &type);
+
+    out:
+        buffers_free(lt);
+        return ret;
+}
+
+/** linktest_report - prints the results for one frame size.
+ * @lt:   pointer to the linktest struct.
+ * @size: frame size tested.
+ * @res:  results.
+ */
+static void linktest_report(struct linktest *lt, const struct linktest_size *size, const struct linktest_result *res)
+{
+    double span = res->last_ts - res->first_ts;
+    uint64_t intervals = res->frames > 1 ? res->frames - 1 : 0;
+    double mean = intervals ? res->interval_sum / intervals : 0;
+    double jitter = intervals ? sqrt(res->interval_sq_sum / intervals - mean * mean) : 0;
+
+    printf("%ux%u pattern %d\n", size->width, size->height, lt->pattern);
+    printf("  frames       %llu, %.2f fps\n", (unsigned long long)res->frames, span > 0 ? intervals / span : 0);
+    printf("  dropped      %llu", (unsigned long long)res->dropped);
+    if(res->sensor_frames)
+        printf(" (sensor sent %lld, %lld lost after the sensor)", (long long)res->sensor_frames,
+            (long long)(res->sensor_frames - (int64_t)res->frames));
+    printf("\n");
+    printf("  bad frames   %llu\n", (unsigned long long)res->bad_frames);
+    printf("  bit errors   %llu, BER %.3g\n", (unsigned long long)res->bit_errors,
+        res->bits_checked ? (double)res->bit_errors / res->bits_checked : 0);
+    printf("  interval     mean %.1f us, jitter %.1f us, min %.1f us, max %.1f us\n",
+        mean * 1e6, jitter * 1e6, intervals ? res->interval_min * 1e6 : 0, res->interval_max * 1e6);
+}
+
+
+/***************************************************
+        Setup
+****************************************************/
+
+/** sizes_enum - lists the frame sizes the node supports.
+ * @lt: pointer to the linktest struct.
+ */
+static int sizes_enum(struct linktest *lt)
+{
+    struct v4l2_frmsizeenum frmsize;
+    int i;
+
+    lt->fmt.type = V4L2_BUF_TYPE_VIDEO_CAPTURE;
+    if(xioctl(lt->fd, VIDIOC_G_FMT, &lt->fmt))
+    {
+        perror("VIDIOC_G_FMT");
+        return -1;
+    }
+
+    memset(&frmsize, 0, sizeof(frmsize));
+    frmsize.pixel_format = lt->fmt.fmt.pix.pixelformat;
+
+    while(lt->num_sizes < LINKTEST_MAX_SIZES && !xioctl(lt->fd, VIDIOC_ENUM_FRAMESIZES, &frmsize))
+    {
+        if(frmsize.type != V4L2_FRMSIZE_TYPE_DISCRETE) break;
+
+        /* modes that differ only in frame rate share a size */
+        for(i = 0; i < lt->num_sizes; i++)
+        {
+            if(lt->sizes[i].width == frmsize.discrete.width &&
+               lt->sizes[i].height == frmsize.discrete.height) break;
+        }
+
+        if(i == lt->num_sizes)
+        {
+            lt->sizes[i].width = frmsize.discrete.width;
+            lt->sizes[i].height = frmsize.discrete.height;
+            lt->num_sizes++;
+        }
+
+        frmsize.index++;
+    }
+
+    /* fall back to the current format */
+    if(!lt->num_sizes)
+    {
+        lt->sizes[0].width = lt->fmt.fmt.pix.width;
+        lt->sizes[0].height = lt->fmt.fmt.pix.height;
+        lt->num_sizes = 1;
+    }
+
+    return 0;
+}
+
+static void usage(const char *name)
+{
+    fprintf(stderr,
+        "usage: %s [-d device] [-p pattern] [-t seconds] [-r fps] [-s WxH]... [-n buffers] [-v]\n"
+        "  -d  video node, default /dev/video0\n"
+        "  -p  Test Pattern menu index, default %d (walking 1s)\n"
+        "  -t  seconds per frame size, default 5\n"
+        "  -r  frame rate to request, default the mode rate\n"
+        "  -s  frame size to test, repeatable, default all\n"
+        "  -n  number of buffers, default 4\n"
+        "  -v  report every bad frame\n",
+        name, LINKTEST_DEF_PATTERN);
+}
+
+int main(int argc, char **argv)
+{
+    struct linktest lt;
+    struct linktest_result res;
+    int failed = 0;
+    int opt;
+    int i;
+
+    memset(&lt, 0, sizeof(lt));
+    lt.device = "/dev/video0";
+    lt.pattern = LINKTEST_DEF_PATTERN;
+    lt.seconds = 5;
+    lt.num_buffers = 4;
+
+    while((opt = getopt(argc, argv, "d:p:t:r:s:n:vh")) != -1)
+    {
+        switch(opt)
+        {
+            case 'd':
+                lt.device = optarg;
+                break;
+            case 'p':
+                lt.pattern = atoi(optarg);
+                break;
+            case 't':
+                lt.seconds = atoi(optarg);
+                break;
+            case 'r':
+                lt.fps = atoi(optarg);
+                break;
+            case 's':
+                if(lt.num_sizes == LINKTEST_MAX_SIZES ||
+                   sscanf(optarg, "%ux%u", &lt.sizes[lt.num_sizes].width, &lt.sizes[lt.num_sizes].height) != 2)
+                {
+                    usage(argv[0]);
+                    return 1;
+                }
+                lt.num_sizes++;
+                break;
+            case 'n':
+                lt.num_buffers = atoi(optarg);
+                break;
+            case 'v':
+                lt.verbose = 1;
+                break;
+            default:
+                usage(argv[0]);
+                return 1;
+        }
+    }
+
+    if(lt.pattern <= 0 || lt.seconds <= 0 || lt.num_buffers < 2 || lt.num_buffers > LINKTEST_MAX_BUFFERS)
+    {
+        usage(argv[0]);
+        return 1;
+    }
+
+    lt.fd = open(lt.device, O_RDWR | O_NONBLOCK);
+    if(lt.fd < 0)
+    {
+        perror(lt.device);
+        return 1;
+    }
+
+    if(!lt.num_sizes && sizes_enum(&lt))
+    {
+        close(lt.fd);
+        return 1;
+    }
+
+    for(i = 0; i < lt.num_sizes; i++)
+    {
+        if(linktest_run(&lt, &lt.sizes[i], &res))
+        {
+            fprintf(stderr, "%ux%u: run failed\n", lt.sizes[i].width, lt.sizes[i].height);
+            failed = 1;
+        }
+
+        linktest_report(&lt, &lt.sizes[i], &res);
+        if(res.bad_frames || res.dropped || !res.frames) failed = 1;
+    }
+
+    /* leave the sensor streaming real images */
+    ctrl_set(&lt, V4L2_CID_TEST_PATTERN, 0);
+
+    close(lt.fd);
+    return failed;
+}
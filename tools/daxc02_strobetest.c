@@ -0,0 +1,427 @@
+/*
+ * daxc02_strobetest.c - On-board check of the DAX-C02 exposure timestamps.
+ *
+ * Needs a DAX-C02 whose MT9M021 strobe output is wired to the GPIO named by
+ * strobe-gpios.  Streams the video node, subscribes to
+ * DAXC02_EVENT_EXPOSURE on the sensor subdev and dequeues one event per
+ * strobe pulse.  Each event must carry the next frame number, a non-zero
+ * strobe width and a later exposure midpoint than the one before it.
+ *
+ * This is a manual check run on the target, the strobe interrupt cannot be
+ * driven without the hardware.  The L4T 28 kernel is 4.4, which has neither
+ * gpio-mockup (4.9) nor gpio-sim (5.17) to toggle a simulated line, and the
+ * strobe GPIO is only requested once the sensor behind the bridge probes.
+ *
+ * Build on the target:
+ *     gcc -O2 -Wall -o daxc02_strobetest daxc02_strobetest.c
+ *
+ * Usage:
+ *     daxc02_strobetest [-d /dev/video0] [-s /dev/v4l-subdev0] [-e events]
+ *                       [-n buffers] [-v]
+ */
+
+#include <errno.h>
+#include <fcntl.h>
+#include <getopt.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#include <sys/ioctl.h>
+#include <sys/mman.h>
+#include <sys/select.h>
+
+#include <linux/videodev2.h>
+
+#define STROBETEST_MAX_BUFFERS      16
+#define STROBETEST_TIMEOUT_S        2
+
+/* DAXC02_EVENT_EXPOSURE and struct daxc02_event_data, from daxc02.h */
+#define STROBETEST_EVENT_EXPOSURE   ((V4L2_EVENT_PRIVATE_START | 0x2000) + 5)
+
+struct strobetest_event_data {
+    uint32_t frame;
+    uint32_t id;
+    int64_t value;
+    uint32_t source;
+};
+
+struct strobetest_buffer {
+    void *start;
+    size_t length;
+};
+
+struct strobetest_result {
+    uint64_t events;
+    uint64_t frames;
+    uint64_t frame_gaps;
+    uint64_t out_of_order;
+    uint64_t zero_width;
+    uint32_t last_frame;
+    int64_t first_midpoint;
+    int64_t last_midpoint;
+    uint32_t width_min;
+    uint32_t width_max;
+    uint64_t width_sum;
+};
+
+struct strobetest {
+    const char *device;
+    const char *subdev;
+    int fd;
+    int subdev_fd;
+    int num_events;
+    int num_buffers;
+    int verbose;
+
+    struct strobetest_buffer buffers[STROBETEST_MAX_BUFFERS];
+    int buffer_count;
+};
+
+
+/***************************************************
+        Helpers
+****************************************************/
+
+/** xioctl - ioctl that retries on EINTR.
+ * @fd:      file descriptor.
+ * @request: ioctl request.
+ * @arg:     ioctl argument.
+ */
+static int xioctl(int fd, unsigned long request, void *arg)
+{
+    int ret;
+
+    do ret = ioctl(fd, request, arg);
+    while(ret == -1 && errno == EINTR);
+
+    return ret;
+}
+
+
+/***************************************************
+        Buffers
+****************************************************/
+
+/** buffers_free - unmaps and releases the capture buffers.
+ * @st: pointer to the strobetest struct.
+ */
+static void buffers_free(struct strobetest *st)
+{
+    struct v4l2_requestbuffers req;
+    int i;
+
+    for(i = 0; i < st->buffer_count; i++)
+        munmap(st->buffers[i].start, st->buffers[i].length);
+
+    st->buffer_count = 0;
+
+    memset(&req, 0, sizeof(req));
+    req.type = V4L2_BUF_TYPE_VIDEO_CAPTURE;
+    req.memory = V4L2_MEMORY_MMAP;
+    xioctl(st->fd, VIDIOC_REQBUFS, &req);
+}
+
+/** buffers_alloc - requests, maps and queues the capture buffers.
+ * @st: pointer to the strobetest struct.
+ */
+static int buffers_alloc(struct strobetest *st)
+{
+    struct v4l2_requestbuffers req;
+    struct v4l2_buffer buf;
+    int i;
+
+    memset(&req, 0, sizeof(req));
+    req.count = st->num_buffers;
+    req.type = V4L2_BUF_TYPE_VIDEO_CAPTURE;
+    req.memory = V4L2_MEMORY_MMAP;
+
+    if(xioctl(st->fd, VIDIOC_REQBUFS, &req))
+    {
+        perror("VIDIOC_REQBUFS");
+        return -1;
+    }
+
+    for(i = 0; i < (int)req.count && i < STROBETEST_MAX_BUFFERS; i++)
+    {
+        memset(&buf, 0, sizeof(buf));
+        buf.type = V4L2_BUF_TYPE_VIDEO_CAPTURE;
+        buf.memory = V4L2_MEMORY_MMAP;
+        buf.index = i;
+
+        if(xioctl(st->fd, VIDIOC_QUERYBUF, &buf))
+        {
+            perror("VIDIOC_QUERYBUF");
+            return -1;
+        }
+
+        st->buffers[i].length = buf.length;
+        st->buffers[i].start = mmap(NULL, buf.length, PROT_READ | PROT_WRITE, MAP_SHARED, st->fd, buf.m.offset);
+        if(st->buffers[i].start == MAP_FAILED)
+        {
+            perror("mmap");
+            return -1;
+        }
+        st->buffer_count++;
+
+        if(xioctl(st->fd, VIDIOC_QBUF, &buf))
+        {
+            perror("VIDIOC_QBUF");
+            return -1;
+        }
+    }
+
+    return 0;
+}
+
+
+/***************************************************
+        Test Run
+****************************************************/
+
+/** event_check - checks one exposure event against the one before it.
+ * @st:   pointer to the strobetest struct.
+ * @data: event payload.
+ * @res:  results to update.
+ */
+static void event_check(struct strobetest *st, const struct strobetest_event_data *data, struct strobetest_result *res)
+{
+    if(res->events)
+    {
+        if(data->frame != res->last_frame + 1)
+        {
+            res->frame_gaps++;
+            if(st->verbose) fprintf(stderr, "frame %u: expected %u\n", data->frame, res->last_frame + 1);
+        }
+
+        if(data->value <= res->last_midpoint)
+        {
+            res->out_of_order++;
+            if(st->verbose) fprintf(stderr, "frame %u: midpoint %lld ns not after %lld ns\n", data->frame,
+                (long long)data->value, (long long)res->last_midpoint);
+        }
+    }
+    else
+    {
+        res->first_midpoint = data->value;
+        res->width_min = data->id;
+    }
+
+    if(!data->id) res->zero_width++;
+    if(data->id < res->width_min) res->width_min = data->id;
+    if(data->id > res->width_max) res->width_max = data->id;
+    res->width_sum += data->id;
+
+    if(st->verbose) printf("frame %u: width %u us, midpoint %lld ns\n", data->frame, data->id, (long long)data->value);
+
+    res->last_frame = data->frame;
+    res->last_midpoint = data->value;
+    res->events++;
+}
+
+/** strobetest_run - streams until enough exposure events are dequeued.
+ * @st:  pointer to the strobetest struct.
+ * @res: results.
+ */
+static int strobetest_run(struct strobetest *st, struct strobetest_result *res)
+{
+    enum v4l2_buf_type type = V4L2_BUF_TYPE_VIDEO_CAPTURE;
+    struct strobetest_event_data data;
+    struct v4l2_event_subscription sub;
+    struct v4l2_event event;
+    struct v4l2_buffer buf;
+    struct timeval timeout;
+    fd_set rfds, efds;
+    int nfds;
+    int ret = 0;
+
+    memset(res, 0, sizeof(*res));
+
+    /* fails with EINVAL on drivers that do not queue exposure events */
+    memset(&sub, 0, sizeof(sub));
+    sub.type = STROBETEST_EVENT_EXPOSURE;
+    if(xioctl(st->subdev_fd, VIDIOC_SUBSCRIBE_EVENT, &sub))
+    {
+        perror("VIDIOC_SUBSCRIBE_EVENT");
+        return -1;
+    }
+
+    if(buffers_alloc(st))
+    {
+        ret = -1;
+        goto out;
+    }
+
+    if(xioctl(st->fd, VIDIOC_STREAMON, &type))
+    {
+        perror("VIDIOC_STREAMON");
+        ret = -1;
+        goto out;
+    }
+
+    nfds = (st->fd > st->subdev_fd ? st->fd : st->subdev_fd) + 1;
+
+    while(res->events < (uint64_t)st->num_events)
+    {
+        FD_ZERO(&rfds);
+        FD_ZERO(&efds);
+        FD_SET(st->fd, &rfds);
+        FD_SET(st->subdev_fd, &efds);
+        timeout.tv_sec = STROBETEST_TIMEOUT_S;
+        timeout.tv_usec = 0;
+
+        ret = select(nfds, &rfds, NULL, &efds, &timeout);
+        if(ret < 0 && errno == EINTR) continue;
+        if(ret <= 0)
+        {
+            fprintf(stderr, "%s\n", ret ? "select failed" : "timed out waiting for a frame or strobe");
+            ret = -1;
+            break;
+        }
+        ret = 0;
+
+        /* pending events raise an exception on the subdev */
+        if(FD_ISSET(st->subdev_fd, &efds))
+        {
+            while(!xioctl(st->subdev_fd, VIDIOC_DQEVENT, &event))
+            {
+                if(event.type != STROBETEST_EVENT_EXPOSURE) continue;
+
+                memcpy(&data, event.u.data, sizeof(data));
+                event_check(st, &data, res);
+            }
+        }
+
+        if(!FD_ISSET(st->fd, &rfds)) continue;
+
+        memset(&buf, 0, sizeof(buf));
+        buf.type = V4L2_BUF_TYPE_VIDEO_CAPTURE;
+        buf.memory = V4L2_MEMORY_MMAP;
+
+        if(xioctl(st->fd, VIDIOC_DQBUF, &buf))
+        {
+            if(errno == EAGAIN) continue;
+            perror("VIDIOC_DQBUF");
+            ret = -1;
+            break;
+        }
+
+        res->frames++;
+
+        if(xioctl(st->fd, VIDIOC_QBUF, &buf))
+        {
+            perror("VIDIOC_QBUF");
+            ret = -1;
+            break;
+        }
+    }
+
+    xioctl(st->fd, VIDIOC_STREAMOFF, &type);
+
+    out:
+        buffers_free(st);
+        xioctl(st->subdev_fd, VIDIOC_UNSUBSCRIBE_EVENT, &sub);
+
+    return ret;
+}
+
+/** strobetest_report - prints the results.
+ * @st:  pointer to the strobetest struct.
+ * @res: results.
+ */
+static void strobetest_report(struct strobetest *st, const struct strobetest_result *res)
+{
+    double span = (res->last_midpoint - res->first_midpoint) / 1e9;
+
+    printf("%s:\n", st->subdev);
+    printf("  events       %llu over %llu frames\n", (unsigned long long)res->events, (unsigned long long)res->frames);
+    printf("  strobe rate  %.2f Hz\n", res->events > 1 && span > 0 ? (res->events - 1) / span : 0);
+    printf("  width        mean %.1f us, min %u us, max %u us\n",
+        res->events ? (double)res->width_sum / res->events : 0, res->width_min, res->width_max);
+    printf("  frame gaps   %llu\n", (unsigned long long)res->frame_gaps);
+    printf("  out of order %llu\n", (unsigned long long)res->out_of_order);
+    printf("  zero width   %llu\n", (unsigned long long)res->zero_width);
+}
+
+static void usage(const char *name)
+{
+    fprintf(stderr,
+        "usage: %s [-d device] [-s subdev] [-e events] [-n buffers] [-v]\n"
+        "  -d  video node, default /dev/video0\n"
+        "  -s  sensor subdev node, default /dev/v4l-subdev0\n"
+        "  -e  exposure events to check, default 100\n"
+        "  -n  number of buffers, default 4\n"
+        "  -v  print every event\n",
+        name);
+}
+
+int main(int argc, char **argv)
+{
+    struct strobetest st;
+    struct strobetest_result res;
+    int failed;
+    int opt;
+
+    memset(&st, 0, sizeof(st));
+    st.device = "/dev/video0";
+    st.subdev = "/dev/v4l-subdev0";
+    st.num_events = 100;
+    st.num_buffers = 4;
+
+    while((opt = getopt(argc, argv, "d:s:e:n:vh")) != -1)
+    {
+        switch(opt)
+        {
+            case 'd':
+                st.device = optarg;
+                break;
+            case 's':
+                st.subdev = optarg;
+                break;
+            case 'e':
+                st.num_events = atoi(optarg);
+                break;
+            case 'n':
+                st.num_buffers = atoi(optarg);
+                break;
+            case 'v':
+                st.verbose = 1;
+                break;
+            default:
+                usage(argv[0]);
+                return 1;
+        }
+    }
+
+    if(st.num_events <= 0 || st.num_buffers < 2 || st.num_buffers > STROBETEST_MAX_BUFFERS)
+    {
+        usage(argv[0]);
+        return 1;
+    }
+
+    st.fd = open(st.device, O_RDWR | O_NONBLOCK);
+    if(st.fd < 0)
+    {
+        perror(st.device);
+        return 1;
+    }
+
+    st.subdev_fd = open(st.subdev, O_RDWR | O_NONBLOCK);
+    if(st.subdev_fd < 0)
+    {
+        perror(st.subdev);
+        close(st.fd);
+        return 1;
+    }
+
+    failed = strobetest_run(&st, &res) ? 1 : 0;
+    strobetest_report(&st, &res);
+
+    if(res.events < (uint64_t)st.num_events || res.frame_gaps || res.out_of_order || res.zero_width) failed = 1;
+
+    close(st.subdev_fd);
+    close(st.fd);
+    return failed;
+}
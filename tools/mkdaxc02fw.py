@@ -0,0 +1,241 @@
+#!/usr/bin/env python3
+#
+# Builds the optional DAX-C02 register table firmware blob.
+#
+# Usage:
+#   mkdaxc02fw.py extract [-s SRCDIR] > tables.json
+#   mkdaxc02fw.py build tables.json daxc02.bin
+#   mkdaxc02fw.py info daxc02.bin
+#
+# 'extract' writes the tables compiled into the driver as JSON, a starting
+# point for tuning.  'build' packs a JSON description into a blob in the
+# format described in daxc02.h.  Copy the blob to /lib/firmware and name it
+# with the firmware-name property of the sensor node.
+#
+# JSON layout, register addresses and values may be numbers or hex strings:
+#   {
+#     "revision": 1,
+#     "common": [["0x3088", "0x8000"], ["wait", 200], ...],
+#     "bridge": [[2, "0x0004", "0x0004"], [4, "0x0140", "0x00000000"], ...],
+#     "modes": [
+#       {"width": 1280, "height": 720, "fps": 30, "hfr": false,
+#        "regs": [["0x3002", "0x0078"], ...]},
+#       ...
+#     ]
+#   }
+#
+
+import argparse
+import json
+import os
+import re
+import struct
+import sys
+import zlib
+
+FW_MAGIC = 0x32435844
+FW_VERSION = 1
+FW_MAX_MODES = 16
+FW_MAX_ENTRIES = 1024
+
+SECTION_COMMON = 0
+SECTION_MODE = 1
+SECTION_BRIDGE = 2
+SECTION_FRMFMT = 3
+
+FRMFMT_HFR = 0x0001
+
+TABLE_WAIT_MS = 0
+TABLE_END = 1
+
+HEADER = struct.Struct('<IHHIII')
+SECTION = struct.Struct('<HHI')
+REG = struct.Struct('<HH')
+BRIDGE = struct.Struct('<HHI')
+FRMFMT = struct.Struct('<HHHH')
+
+
+def number(value):
+    if isinstance(value, str):
+        return int(value, 0)
+    return int(value)
+
+
+def pack_regs(regs):
+    out = b''
+    for entry in regs:
+        if entry[0] == 'wait':
+            out += REG.pack(TABLE_WAIT_MS, number(entry[1]))
+            continue
+        addr, val = number(entry[0]), number(entry[1])
+        if addr in (TABLE_WAIT_MS, TABLE_END):
+            raise ValueError('register 0x%04x is reserved' % addr)
+        out += REG.pack(addr, val)
+    return out
+
+
+def section(kind, index, count, payload):
+    if count > FW_MAX_ENTRIES:
+        raise ValueError('section %d has %d entries, max %d' % (kind, count, FW_MAX_ENTRIES))
+    return SECTION.pack(kind, index, count) + payload
+
+
+def build(desc):
+    modes = desc['modes']
+    if not 0 < len(modes) <= FW_MAX_MODES:
+        raise ValueError('need 1-%d modes' % FW_MAX_MODES)
+
+    body = section(SECTION_COMMON, 0, len(desc['common']), pack_regs(desc['common']))
+
+    bridge = b''
+    for width, addr, data in desc['bridge']:
+        if number(width) not in (2, 4):
+            raise ValueError('bridge register 0x%04x width must be 2 or 4' % number(addr))
+        bridge += BRIDGE.pack(number(addr), number(width), number(data))
+    body += section(SECTION_BRIDGE, 0, len(desc['bridge']), bridge)
+
+    frmfmt = b''
+    for mode in modes:
+        flags = FRMFMT_HFR if mode.get('hfr') else 0
+        frmfmt += FRMFMT.pack(mode['width'], mode['height'], mode['fps'], flags)
+    body += section(SECTION_FRMFMT, 0, len(modes), frmfmt)
+
+    for index, mode in enumerate(modes):
+        body += section(SECTION_MODE, index, len(mode['regs']), pack_regs(mode['regs']))
+
+    header = HEADER.pack(FW_MAGIC, FW_VERSION, len(modes), number(desc.get('revision', 0)),
+                         HEADER.size + len(body), zlib.crc32(body) & 0xffffffff)
+    return header + body
+
+
+def info(blob):
+    magic, version, num_modes, revision, size, crc = HEADER.unpack_from(blob)
+    if magic != FW_MAGIC:
+        raise ValueError('bad magic 0x%08x' % magic)
+    body = blob[HEADER.size:]
+    print('version %d, revision %d, %d modes, %d bytes' % (version, revision, num_modes, size))
+    print('size %s, crc %s' % ('ok' if size == len(blob) else 'MISMATCH',
+                               'ok' if zlib.crc32(body) & 0xffffffff == crc else 'MISMATCH'))
+
+    names = {SECTION_COMMON: 'common', SECTION_MODE: 'mode', SECTION_BRIDGE: 'bridge', SECTION_FRMFMT: 'frmfmt'}
+    sizes = {SECTION_COMMON: REG.size, SECTION_MODE: REG.size, SECTION_BRIDGE: BRIDGE.size, SECTION_FRMFMT: FRMFMT.size}
+    offset = 0
+    while offset < len(body):
+        kind, index, count = SECTION.unpack_from(body, offset)
+        offset += SECTION.size
+        if kind not in names:
+            raise ValueError('unknown section %d' % kind)
+        if kind == SECTION_FRMFMT:
+            for i in range(count):
+                w, h, fps, flags = FRMFMT.unpack_from(body, offset + i * FRMFMT.size)
+                print('  mode %d: %dx%d @ %d fps%s' % (i, w, h, fps, ', hfr' if flags & FRMFMT_HFR else ''))
+        else:
+            label = names[kind] + (' %d' % index if kind == SECTION_MODE else '')
+            print('  %s: %d entries' % (label, count))
+        offset += count * sizes[kind]
+
+
+def extract(srcdir):
+    """Reads the tables compiled into the driver."""
+    sources = {}
+    for name in ('daxc02.h', 'daxc02_mode_tbls.h', 'daxc02.c'):
+        with open(os.path.join(srcdir, name)) as f:
+            sources[name] = re.sub(r'/\*.*?\*/|//[^\n]*', '', f.read(), flags=re.S)
+
+    defines = {}
+    for text in sources.values():
+        for name, value in re.findall(r'#define\s+(\w+)\s+(0x[0-9A-Fa-f]+|\d+)\b', text):
+            defines[name] = int(value, 0)
+
+    def resolve(token):
+        token = token.strip()
+        return defines[token] if token in defines else int(token, 0)
+
+    def body(text, pattern):
+        match = re.search(pattern + r'\s*=\s*\{(.*?)\n\};', text, re.S)
+        if not match:
+            raise ValueError('table %s not found' % pattern)
+        return match.group(1)
+
+    def regs(name):
+        out = []
+        for addr, val in re.findall(r'\{\s*(\w+)\s*,\s*(\w+)\s*\}', body(tables, r'struct reg_16 ' + name + r'\[\]')):
+            addr, val = resolve(addr), resolve(val)
+            if addr == TABLE_END:
+                break
+            out.append(['wait', val] if addr == TABLE_WAIT_MS else ['0x%04X' % addr, '0x%04X' % val])
+        return out
+
+    tables = sources['daxc02_mode_tbls.h']
+
+    enum = re.search(r'enum\s*\{(.*?)\};', tables, re.S).group(1)
+    modes = [m.strip() for m in enum.split(',') if m.strip()]
+
+    mode_table = dict(re.findall(r'\[(\w+)\]\s*=\s*(\w+)', body(tables, r'\*mode_table\[\]')))
+    profiles = dict(re.findall(r'\[(\w+)\]\s*=\s*(\w+)', body(tables, r'daxc02_isp_profile\[\]')))
+    fps = {}
+    for name, value in re.findall(r'static const int (\w+)\[\]\s*=\s*\{\s*(\d+)', tables):
+        fps[name] = int(value)
+
+    frmfmt = {}
+    for w, h, rates, mode in re.findall(r'\{\{\s*(\d+)\s*,\s*(\d+)\s*\}\s*,\s*(\w+)\s*,\s*\d+\s*,\s*\d+\s*,\s*(\w+)\s*\}',
+                                         body(tables, r'daxc02_frmfmt\[\]')):
+        frmfmt[mode] = (int(w), int(h), fps[rates])
+
+    bridge = []
+    for width, addr, data in re.findall(r'\{\s*(\d)\s*,\s*(\w+)\s*,\s*(\w+)\s*\}',
+                                        body(sources['daxc02.c'], r'daxc02_buffer_config\[\]')):
+        bridge.append([int(width), '0x%04X' % resolve(addr), '0x%0*X' % (int(width) * 2, resolve(data))])
+
+    return {
+        'revision': 0,
+        'common': regs('daxc02_mode_table_common'),
+        'bridge': bridge,
+        'modes': [{
+            'width': frmfmt[mode][0],
+            'height': frmfmt[mode][1],
+            'fps': frmfmt[mode][2],
+            'hfr': profiles.get(mode) == 'DAXC02_ISP_PROFILE_HFR',
+            'regs': regs(mode_table[mode]),
+        } for mode in modes],
+    }
+
+
+def main():
+    parser = argparse.ArgumentParser(description='DAX-C02 register table firmware tool')
+    sub = parser.add_subparsers(dest='cmd')
+
+    p = sub.add_parser('extract', help='dump the built in tables as JSON')
+    p.add_argument('-s', '--src', default=os.path.join(os.path.dirname(os.path.abspath(__file__)), '..'),
+                   help='driver source directory')
+
+    p = sub.add_parser('build', help='pack a JSON description into a blob')
+    p.add_argument('json')
+    p.add_argument('blob')
+
+    p = sub.add_parser('info', help='validate and summarize a blob')
+    p.add_argument('blob')
+
+    args = parser.parse_args()
+
+    if args.cmd == 'extract':
+        json.dump(extract(args.src), sys.stdout, indent=2)
+        sys.stdout.write('\n')
+    elif args.cmd == 'build':
+        with open(args.json) as f:
+            blob = build(json.load(f))
+        with open(args.blob, 'wb') as f:
+            f.write(blob)
+        info(blob)
+    elif args.cmd == 'info':
+        with open(args.blob, 'rb') as f:
+            info(f.read())
+    else:
+        parser.print_help()
+        return 1
+
+    return 0
+
+
+if __name__ == '__main__':
+    sys.exit(main())